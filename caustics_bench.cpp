@@ -0,0 +1,334 @@
+// Throughput benchmarks for the CPU side of the pipeline: the wave solver,
+// disturbance stamps, water mesh generation, the ray tracer and the caustics
+// maps. Needs no window or GL context. Results go to stdout (or --output) as
+// JSON so runs can be compared by scripts; progress is reported on stderr.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "caustics_map.h"
+#include "photon_caustics.h"
+#include "ray_packet.h"
+#include "ray_tracing.h"
+#include "simulation.h"
+#include "water_chunks.h"
+#include "water_mesh.h"
+
+struct BenchResult {
+    std::string name;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    long long iterations = 0;
+    double seconds = 0.0;
+    double rate = 0.0;      // Work units per second
+    std::string unit;
+};
+
+struct BenchOptions {
+    std::vector<int> solverSizes{128, 256, 512, 1024, 2048};
+    int sceneSize = 256;          // Grid size for mesh, tracing and caustics
+    int renderSize = 256;         // Square ray-traced image
+    int causticsSize = 512;       // Square caustics map
+    long long photons = 1000000;  // Photons per photon-traced map
+    double minSeconds = 0.5;      // Each case repeats until at least this long
+    float sparseEpsilon = 1e-4f;  // Sparse solver case (0 = skip)
+    std::string outputPath;       // JSON file; empty writes to stdout
+};
+
+// Calls fn until minSeconds have passed, at least once, and records the
+// iteration count and wall time. workPerCall units make up one call.
+template <typename Fn>
+static BenchResult runCase(const std::string& name, const char* unit, double workPerCall,
+                           double minSeconds, Fn fn) {
+    BenchResult result;
+    result.name = name;
+    result.unit = unit;
+    result.gridWidth = width;
+    result.gridHeight = height;
+
+    auto start = std::chrono::steady_clock::now();
+    do {
+        fn();
+        ++result.iterations;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (result.seconds < minSeconds);
+
+    result.rate = workPerCall * result.iterations / result.seconds;
+    std::cerr << "  " << name << " " << width << "x" << height << ": " << result.rate << " " << unit << std::endl;
+    return result;
+}
+
+// Fresh grid of the given size with a few wave fronts spread across it
+static void prepareGrid(int size) {
+    resize_grid(size, size);
+    init_grid();
+    add_initial_disturbances();
+    update_wave_steps(100);
+}
+
+// Damping decays the waves by about e^-10 every 1000 steps; left alone they
+// would sink into denormals and the solver would be timed on those instead
+static void keepWavesAlive(int steps) {
+    static int sinceDisturbance = 0;
+    sinceDisturbance += steps;
+    if (sinceDisturbance >= 1000) {
+        add_initial_disturbances();
+        sinceDisturbance = 0;
+    }
+}
+
+static void benchSolver(const BenchOptions& options, std::vector<BenchResult>& results) {
+    for (int size : options.solverSizes) {
+        prepareGrid(size);
+        const double cells = double(size - 2) * double(size - 2);
+        results.push_back(runCase("update_wave", "cell_updates_per_s", cells, options.minSeconds, [] {
+            update_wave();
+            keepWavesAlive(1);
+        }));
+        if (temporalBlockSteps > 1) {
+            prepareGrid(size);
+            results.push_back(runCase("update_wave_blocked", "cell_updates_per_s", cells * temporalBlockSteps,
+                                      options.minSeconds, [] {
+                update_wave_blocked(temporalBlockSteps);
+                keepWavesAlive(temporalBlockSteps);
+            }));
+        }
+        if (options.sparseEpsilon > 0.0f) {
+            // Counted as the whole grid, so the rate is comparable with the
+            // dense cases; the splashes cover a small part of large grids
+            sparseEpsilon = options.sparseEpsilon;
+            prepareGrid(size);
+            results.push_back(runCase("update_wave_sparse", "cell_updates_per_s", cells, options.minSeconds, [] {
+                update_wave();
+                keepWavesAlive(1);
+            }));
+            sparseEpsilon = 0.0f;
+        }
+    }
+}
+
+// Rain on the scene grid: batches of small drops pushed through the
+// disturbance queue and stamped, as the solver does at the start of a step.
+// Alternating signs keep the field from growing.
+static void benchDisturbances(const BenchOptions& options, std::vector<BenchResult>& results) {
+    prepareGrid(options.sceneSize);
+    std::vector<Disturbance> drops(1024);
+    for (size_t k = 0; k < drops.size(); ++k) {
+        drops[k].x = 1.0f + (k * 37) % (width - 2);
+        drops[k].y = 1.0f + (k * 91) % (height - 2);
+        drops[k].radius = 1.5f + (k % 3) * 0.5f;
+        drops[k].amplitude = (k % 2) ? 0.2f : -0.2f;
+    }
+    results.push_back(runCase("disturbance_stamps", "stamps_per_s", double(drops.size()), options.minSeconds, [&] {
+        queue_disturbances(drops.data(), drops.size());
+        apply_queued_disturbances();
+    }));
+}
+
+static void benchMesh(const BenchOptions& options, std::vector<BenchResult>& results) {
+    prepareGrid(options.sceneSize);
+    const double vertices = double(width) * double(height);
+
+    std::vector<float> gridXY;
+    std::vector<unsigned int> indices;
+    results.push_back(runCase("mesh_static", "vertices_per_s", vertices, options.minSeconds, [&] {
+        generateWaterGridXY(gridXY);
+        generateWaterIndices(indices);
+    }));
+
+    std::vector<WaterSurfaceVertex> surface;
+    results.push_back(runCase("mesh_surface", "vertices_per_s", vertices, options.minSeconds,
+                              [&] { generateWaterSurface(surface, 0.5f); }));
+
+    std::vector<float> surfaceHeights;
+    results.push_back(runCase("mesh_heights", "vertices_per_s", vertices, options.minSeconds,
+                              [&] { generateWaterHeights(surfaceHeights, 0.5f); }));
+
+    // Per-frame chunk culling and level selection, seen from the app's
+    // default camera
+    WaterChunkMesh chunks;
+    chunks.build(width, height, WaterChunkMesh::kDefaultChunkQuads, waterScale, BOTTOM_Z, 10.0f);
+    const glm::vec3 eye(0.0f, 0.0f, 80.0f);
+    const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 800.0f / 600.0f, 0.1f, 300.0f) *
+                                     glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    std::vector<int> levels;
+    WaterDrawList drawList;
+    results.push_back(runCase("mesh_chunk_lod", "chunks_per_s", chunks.chunkCount(), options.minSeconds, [&] {
+        chunks.selectLevels(levels, viewProjection, eye, 120.0f);
+        chunks.buildDrawList(levels, drawList);
+    }));
+}
+
+static void benchTracing(const BenchOptions& options, std::vector<BenchResult>& results) {
+    prepareGrid(options.sceneSize);
+    Framebuffer framebuffer;
+    framebuffer.resize(options.renderSize, options.renderSize);
+    const double rays = double(options.renderSize) * options.renderSize;
+
+    RenderSettings settings;
+    settings.marchHeightField = false;
+    settings.packetIsa = SimdIsa::Scalar;
+    results.push_back(runCase("trace_plane_scalar", "rays_per_s", rays, options.minSeconds,
+                              [&] { renderScene(framebuffer, settings); }));
+
+    settings.packetIsa = detectSimdIsa();
+    if (getPacketTraceKernel(settings.packetIsa)) {
+        std::string name = "trace_plane_packet" + std::to_string(packetLaneCount(settings.packetIsa));
+        results.push_back(runCase(name, "rays_per_s", rays, options.minSeconds,
+                                  [&] { renderScene(framebuffer, settings); }));
+    }
+
+    // The first render builds the whole pyramid; later ones find nothing
+    // changed, so only the marching itself is timed
+    settings.marchHeightField = true;
+    renderScene(framebuffer, settings);
+    results.push_back(runCase("trace_height_field", "rays_per_s", rays, options.minSeconds,
+                              [&] { renderScene(framebuffer, settings); }));
+}
+
+static void benchCaustics(const BenchOptions& options, std::vector<BenchResult>& results) {
+    prepareGrid(options.sceneSize);
+    const glm::vec3 lightPos(0.0f, 0.0f, 100.0f);
+
+    std::vector<float> map;
+    const CausticsMapBounds bounds = poolCausticsBounds(lightPos);
+    const double triangles = 2.0 * (width - 1) * (height - 1);
+    results.push_back(runCase("caustics_map", "triangles_per_s", triangles, options.minSeconds, [&] {
+        computeCausticsMap(map, options.causticsSize, options.causticsSize, bounds, lightPos);
+    }));
+
+    PhotonCausticsOptions photonOptions;
+    photonOptions.photons = options.photons;
+    photonOptions.mapWidth = photonOptions.mapHeight = options.causticsSize;
+    photonOptions.lightPos = lightPos;
+    photonOptions.bounds = bounds;
+    // Photons are spread evenly over grid cells, so the count actually
+    // traced can differ slightly from the request; a warm-up call gives it
+    const double traced = double(tracePhotonCaustics(photonOptions, map).photons);
+    results.push_back(runCase("photon_caustics", "photons_per_s", traced, options.minSeconds, [&] {
+        tracePhotonCaustics(photonOptions, map);
+    }));
+}
+
+static std::string toJson(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    std::ostringstream out;
+    out.precision(6);
+    out << "{\n"
+        << "  \"simd\": \"" << simdIsaName(waveKernelIsa) << "\",\n"
+        << "  \"threads\": " << solverPool().size() << ",\n"
+        << "  \"temporal_block_steps\": " << temporalBlockSteps << ",\n"
+        << "  \"min_seconds\": " << options.minSeconds << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"grid\": [" << r.gridWidth << ", " << r.gridHeight
+            << "], \"iterations\": " << r.iterations << ", \"seconds\": " << r.seconds
+            << ", \"rate\": " << r.rate << ", \"unit\": \"" << r.unit << "\"}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+static bool parseSizes(const char* value, std::vector<int>& sizes) {
+    sizes.clear();
+    std::stringstream list(value);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        int size = std::atoi(item.c_str());
+        if (size < 3) {
+            return false;
+        }
+        sizes.push_back(size);
+    }
+    return !sizes.empty();
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --sizes N,N,...      Solver grid sizes (default 128,256,512,1024,2048)\n"
+              << "  --scene-size N       Grid size for mesh, tracing and caustics (default 256)\n"
+              << "  --render-size N      Ray-traced image size (default 256)\n"
+              << "  --caustics-size N    Caustics map resolution (default 512)\n"
+              << "  --photons N          Photons per photon-traced map (default 1000000)\n"
+              << "  --min-time S         Minimum seconds per case (default 0.5)\n"
+              << "  --threads N          Solver threads (default: one per hardware thread)\n"
+              << "  --block-steps N      Time steps per temporally blocked pass (1 = off)\n"
+              << "  --sparse EPS         Epsilon of the sparse solver case (default 1e-4, 0 = skip)\n"
+              << "  --output FILE        Write the JSON report to FILE instead of stdout\n"
+              << "  --help               Show this message" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            if (!parseSizes(argv[++i], options.solverSizes)) {
+                std::cerr << "--sizes needs a comma separated list of sizes of at least 3" << std::endl;
+                return -1;
+            }
+        } else if (arg == "--scene-size" && hasValue) {
+            options.sceneSize = std::atoi(argv[++i]);
+        } else if (arg == "--render-size" && hasValue) {
+            options.renderSize = std::atoi(argv[++i]);
+        } else if (arg == "--caustics-size" && hasValue) {
+            options.causticsSize = std::atoi(argv[++i]);
+        } else if (arg == "--photons" && hasValue) {
+            options.photons = std::atoll(argv[++i]);
+        } else if (arg == "--min-time" && hasValue) {
+            options.minSeconds = std::atof(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            solverThreads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--block-steps" && hasValue) {
+            temporalBlockSteps = std::atoi(argv[++i]);
+        } else if (arg == "--sparse" && hasValue) {
+            options.sparseEpsilon = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--output" && hasValue) {
+            options.outputPath = argv[++i];
+        } else if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (options.sceneSize < 3 || options.renderSize < 1 || options.causticsSize < 1 || options.photons < 1) {
+        std::cerr << "Sizes and photon count must be positive (scene size at least 3)" << std::endl;
+        return -1;
+    }
+
+    std::cerr << "Benchmarking with " << simdIsaName(waveKernelIsa) << " kernels on "
+              << solverPool().size() << " thread(s)" << std::endl;
+
+    std::vector<BenchResult> results;
+    benchSolver(options, results);
+    benchDisturbances(options, results);
+    benchMesh(options, results);
+    benchTracing(options, results);
+    benchCaustics(options, results);
+
+    std::string json = toJson(options, results);
+    if (options.outputPath.empty()) {
+        std::cout << json;
+        return 0;
+    }
+    std::ofstream file(options.outputPath);
+    if (!file) {
+        std::cerr << "Failed to open " << options.outputPath << " for writing" << std::endl;
+        return -1;
+    }
+    file << json;
+    return file ? 0 : -1;
+}
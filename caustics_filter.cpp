@@ -0,0 +1,157 @@
+#include "caustics_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <glad/glad.h>
+
+bool CausticsFilter::create(int sourceWidth, int sourceHeight, CausticsFormat mapFormat,
+                            const CausticsFilterSettings& filterSettings,
+                            unsigned int blurShader, unsigned int accumulateShader) {
+    destroy();
+    settings = filterSettings;
+    settings.blurRadius = std::min(std::max(settings.blurRadius, 0), kMaxBlurRadius);
+    settings.downscale = std::max(settings.downscale, 1);
+    settings.historyWeight = std::min(std::max(settings.historyWeight, 0.0f), 0.99f);
+    format = mapFormat;
+    blurProgram = blurShader;
+    accumulateProgram = accumulateShader;
+
+    // Normalized Gaussian weights for offsets 0..radius, with the radius at
+    // two standard deviations
+    const int radius = settings.blurRadius;
+    const float sigma = std::max(radius * 0.5f, 0.5f);
+    float total = 0.0f;
+    for (int k = 0; k <= radius; ++k) {
+        weights[k] = std::exp(-0.5f * k * k / (sigma * sigma));
+        total += k == 0 ? weights[k] : 2.0f * weights[k];
+    }
+    for (int k = 0; k <= radius; ++k) {
+        weights[k] /= total;
+    }
+
+    glGenTextures(kTargetCount, textures);
+    glGenFramebuffers(kTargetCount, framebuffers);
+    glGenVertexArrays(1, &emptyVAO);
+    if (!allocate(sourceWidth, sourceHeight)) {
+        destroy();
+        return false;
+    }
+
+    glUseProgram(blurProgram);
+    glUniform1i(glGetUniformLocation(blurProgram, "sourceMap"), 0);
+    texelStepLocation = glGetUniformLocation(blurProgram, "texelStep");
+    outputScaleLocation = glGetUniformLocation(blurProgram, "outputScale");
+    radiusLocation = glGetUniformLocation(blurProgram, "radius");
+    weightsLocation = glGetUniformLocation(blurProgram, "weights");
+    glUniform1i(radiusLocation, radius);
+    glUniform1fv(weightsLocation, radius + 1, weights);
+
+    glUseProgram(accumulateProgram);
+    glUniform1i(glGetUniformLocation(accumulateProgram, "currentMap"), 0);
+    glUniform1i(glGetUniformLocation(accumulateProgram, "historyMap"), 1);
+    historyWeightLocation = glGetUniformLocation(accumulateProgram, "historyWeight");
+    return true;
+}
+
+void CausticsFilter::destroy() {
+    if (textures[0]) {
+        glDeleteFramebuffers(kTargetCount, framebuffers);
+        glDeleteTextures(kTargetCount, textures);
+        glDeleteVertexArrays(1, &emptyVAO);
+        std::fill(textures, textures + kTargetCount, 0u);
+        std::fill(framebuffers, framebuffers + kTargetCount, 0u);
+        emptyVAO = 0;
+    }
+    outputTexture = 0;
+    historyValid = false;
+}
+
+bool CausticsFilter::resize(int sourceWidth, int sourceHeight) {
+    int newWidth = std::max(sourceWidth / settings.downscale, 1);
+    int newHeight = std::max(sourceHeight / settings.downscale, 1);
+    if (newWidth == mapWidth && newHeight == mapHeight) {
+        return true;
+    }
+    return allocate(sourceWidth, sourceHeight);
+}
+
+// (Re)creates every filter map at the reduced size of the source
+bool CausticsFilter::allocate(int sourceWidth, int sourceHeight) {
+    mapWidth = std::max(sourceWidth / settings.downscale, 1);
+    mapHeight = std::max(sourceHeight / settings.downscale, 1);
+    GLint internalFormat = format == CausticsFormat::R32F ? GL_R32F : GL_R16F;
+
+    bool complete = true;
+    for (int k = 0; k < kTargetCount && complete; ++k) {
+        glBindTexture(GL_TEXTURE_2D, textures[k]);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, mapWidth, mapHeight, 0, GL_RED, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[k]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[k], 0);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "Caustics filter FBO incomplete (" << mapWidth << "x" << mapHeight << ")\n";
+    }
+    historyValid = false;
+    return complete;
+}
+
+// One direction of the separable blur from source into target k
+void CausticsFilter::blurPass(unsigned int source, int target, float stepX, float stepY) {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[target]);
+    glBindTexture(GL_TEXTURE_2D, source);
+    glUniform2f(texelStepLocation, stepX, stepY);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void CausticsFilter::apply(unsigned int sourceTexture) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, mapWidth, mapHeight);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(emptyVAO);
+    glActiveTexture(GL_TEXTURE0);
+
+    unsigned int current = sourceTexture;
+    if (settings.blurRadius > 0 || settings.downscale > 1) {
+        // The horizontal pass also resamples the full-size map
+        glUseProgram(blurProgram);
+        glUniform2f(outputScaleLocation, 1.0f / mapWidth, 1.0f / mapHeight);
+        blurPass(current, 0, 1.0f / mapWidth, 0.0f);
+        current = textures[0];
+        if (settings.blurRadius > 0) {
+            blurPass(current, 1, 0.0f, 1.0f / mapHeight);
+            current = textures[1];
+        }
+    }
+
+    if (settings.historyWeight > 0.0f) {
+        const int next = 1 - history;
+        glUseProgram(accumulateProgram);
+        glUniform1f(historyWeightLocation, historyValid ? settings.historyWeight : 0.0f);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[kBlurTargets + next]);
+        glBindTexture(GL_TEXTURE_2D, current);
+        glActiveTexture(GL_TEXTURE0 + 1);
+        glBindTexture(GL_TEXTURE_2D, textures[kBlurTargets + history]);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glActiveTexture(GL_TEXTURE0);
+        history = next;
+        historyValid = true;
+        current = textures[kBlurTargets + next];
+    }
+    outputTexture = current;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "caustics_target.h"
+
+// Post-process settings for the caustics map. The filter runs when either
+// the blur or the temporal accumulation is on.
+struct CausticsFilterSettings {
+    int blurRadius = 0;          // Gaussian radius in filtered texels (0 = off)
+    int downscale = 2;           // Filtered map is the caustics map size divided by this
+    float historyWeight = 0.0f;  // Share of the previous filtered map kept each frame (0 = off)
+
+    bool active() const { return blurRadius > 0 || historyWeight > 0.0f; }
+};
+
+// Filters the caustics map between the caustics and bottom passes: a
+// separable Gaussian blur at reduced resolution, then an exponential moving
+// average over frames. The bottom pass samples output() once per fragment.
+// Needs a current GL context.
+class CausticsFilter {
+public:
+    static constexpr int kMaxBlurRadius = 16;
+
+    CausticsFilter() = default;
+    CausticsFilter(const CausticsFilter&) = delete;
+    CausticsFilter& operator=(const CausticsFilter&) = delete;
+
+    // blurProgram and accumulateProgram are the linked filter shaders (see
+    // causticsBlurFragmentShaderSource and causticsAccumulateFragmentShaderSource)
+    bool create(int sourceWidth, int sourceHeight, CausticsFormat format, const CausticsFilterSettings& settings,
+                unsigned int blurProgram, unsigned int accumulateProgram);
+    void destroy();
+
+    // Follows a resized caustics map; the history starts over
+    bool resize(int sourceWidth, int sourceHeight);
+    // Drops the accumulated history, so the next frame is taken as is
+    void resetHistory() { historyValid = false; }
+
+    // Filters sourceTexture into output(); restores the viewport afterwards
+    void apply(unsigned int sourceTexture);
+
+    unsigned int output() const { return outputTexture; }
+    int width() const { return mapWidth; }
+    int height() const { return mapHeight; }
+
+private:
+    bool allocate(int sourceWidth, int sourceHeight);
+    void blurPass(unsigned int source, int target, float stepX, float stepY);
+
+    // Scratch maps for the two blur passes and the history ping-pong pair
+    static constexpr int kBlurTargets = 2;
+    static constexpr int kTargetCount = kBlurTargets + 2;
+
+    CausticsFilterSettings settings;
+    CausticsFormat format = CausticsFormat::R16F;
+    int mapWidth = 0;
+    int mapHeight = 0;
+    unsigned int textures[kTargetCount] = {};
+    unsigned int framebuffers[kTargetCount] = {};
+    unsigned int emptyVAO = 0;  // Core profile needs a VAO for attribute-less draws
+    unsigned int outputTexture = 0;
+    int history = 0;            // Which history target holds the latest frame
+    bool historyValid = false;
+
+    unsigned int blurProgram = 0;
+    unsigned int accumulateProgram = 0;
+    float weights[kMaxBlurRadius + 1] = {};
+    int texelStepLocation = -1;
+    int outputScaleLocation = -1;
+    int radiusLocation = -1;
+    int weightsLocation = -1;
+    int historyWeightLocation = -1;
+};
@@ -0,0 +1,113 @@
+#include "caustics_map.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+glm::vec3 projectToBottom(const glm::vec3& lightPos, const glm::vec3& surfacePoint,
+                          const glm::vec3& normal) {
+    glm::vec3 incident = glm::normalize(surfacePoint - lightPos);
+    glm::vec3 refracted = glm::refract(incident, normal, AIR_IOR / WATER_IOR);
+    return surfacePoint + refracted * ((BOTTOM_Z - surfacePoint.z) / refracted.z);
+}
+
+CausticsMapBounds poolCausticsBounds(const glm::vec3& lightPos) {
+    const glm::vec3 up(0.0f, 0.0f, 1.0f);
+    const float halfX = width / 2.0f * waterScale;
+    const float halfY = height / 2.0f * waterScale;
+    float low = 0.0f, high = 0.0f;
+    for (float x : {-halfX, halfX}) {
+        for (float y : {-halfY, halfY}) {
+            glm::vec3 hit = projectToBottom(lightPos, glm::vec3(x, y, 0.0f), up);
+            low = std::min({low, hit.x, hit.y});
+            high = std::max({high, hit.x, hit.y});
+        }
+    }
+
+    // Refraction through tilted water moves hits by less than the depth
+    const float margin = -BOTTOM_Z;
+    CausticsMapBounds bounds;
+    bounds.min = low - margin;
+    bounds.size = high - low + 2.0f * margin;
+    return bounds;
+}
+
+// Adds value to every map pixel whose center lies inside the triangle.
+// Vertices are in map pixel units.
+static void splatTriangle(std::vector<float>& map, int mapWidth, int mapHeight,
+                          glm::vec2 a, glm::vec2 b, glm::vec2 c, float value) {
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (area == 0.0f) {
+        return;
+    }
+    // Orient counter-clockwise so the edge functions are positive inside
+    if (area < 0.0f) {
+        std::swap(b, c);
+    }
+
+    int minX = std::max(0, static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))));
+    int maxX = std::min(mapWidth - 1, static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))));
+    int minY = std::max(0, static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))));
+    int maxY = std::min(mapHeight - 1, static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))));
+
+    auto edge = [](const glm::vec2& p, const glm::vec2& q, float x, float y) {
+        return (q.x - p.x) * (y - p.y) - (q.y - p.y) * (x - p.x);
+    };
+
+    for (int py = minY; py <= maxY; ++py) {
+        float y = py + 0.5f;
+        float* row = map.data() + static_cast<size_t>(py) * mapWidth;
+        for (int px = minX; px <= maxX; ++px) {
+            float x = px + 0.5f;
+            if (edge(a, b, x, y) >= 0.0f && edge(b, c, x, y) >= 0.0f && edge(c, a, x, y) >= 0.0f) {
+                row[px] += value;
+            }
+        }
+    }
+}
+
+void computeCausticsMap(std::vector<float>& map, int mapWidth, int mapHeight, const CausticsMapBounds& bounds,
+                        const glm::vec3& lightPos, float alpha) {
+    map.assign(static_cast<size_t>(mapWidth) * mapHeight, 0.0f);
+
+    // Landing points for the flat (rest) and the current surface, in map pixels
+    std::vector<glm::vec2> restPoints(static_cast<size_t>(width) * height);
+    std::vector<glm::vec2> litPoints(restPoints.size());
+    const glm::vec2 toPixels(mapWidth / bounds.size, mapHeight / bounds.size);
+    const glm::vec3 up(0.0f, 0.0f, 1.0f);
+
+    for (int i = 0; i < width; i++) {
+        for (int j = 0; j < height; j++) {
+            glm::vec3 rest((i - width/2.0f) * waterScale, (j - height/2.0f) * waterScale, 0.0f);
+            glm::vec3 surface(rest.x, rest.y, getInterpolatedHeight(i, j, alpha));
+            glm::vec3 normal = (i > 0 && i < width-1 && j > 0 && j < height-1)
+                ? getSurfaceNormal(i, j, alpha) : up;
+
+            size_t index = static_cast<size_t>(i) * height + j;
+            restPoints[index] = (glm::vec2(projectToBottom(lightPos, rest, up)) - bounds.min) * toPixels;
+            litPoints[index] = (glm::vec2(projectToBottom(lightPos, surface, normal)) - bounds.min) * toPixels;
+        }
+    }
+
+    auto triangleArea = [](const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) {
+        return std::fabs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+    };
+    auto splat = [&](size_t a, size_t b, size_t c) {
+        float restArea = triangleArea(restPoints[a], restPoints[b], restPoints[c]);
+        float litArea = triangleArea(litPoints[a], litPoints[b], litPoints[c]);
+        float ratio = restArea / std::max(litArea, restArea / CAUSTICS_MAX_RATIO);
+        splatTriangle(map, mapWidth, mapHeight, litPoints[a], litPoints[b], litPoints[c], ratio);
+    };
+
+    // Same triangulation as generateWaterIndices()
+    for (int i = 0; i < width-1; i++) {
+        for (int j = 0; j < height-1; j++) {
+            size_t topLeft = static_cast<size_t>(i) * height + j;
+            size_t topRight = topLeft + 1;
+            size_t bottomLeft = topLeft + height;
+            size_t bottomRight = bottomLeft + 1;
+            splat(topLeft, bottomLeft, topRight);
+            splat(topRight, bottomLeft, bottomRight);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Physically based caustics on the pool bottom. Light from a point source is
+// refracted through every water vertex and projected onto BOTTOM_Z; each
+// surface triangle then carries the light that would have landed on its
+// flat-water footprint, so its brightness is the ratio of the footprint
+// area to the refracted area (the Jacobian of the light mapping).
+//
+// A map covers a square of the bottom plane (CausticsMapBounds). A value of
+// 1 means the light of undisturbed water.
+const float CAUSTICS_MAP_MIN = -200.0f;  // Range the bottom shader samples
+const float CAUSTICS_MAP_SIZE = 400.0f;
+
+// Square of the bottom plane covered by a caustics map: min to min + size
+// along both x and y
+struct CausticsMapBounds {
+    float min = CAUSTICS_MAP_MIN;
+    float size = CAUSTICS_MAP_SIZE;
+};
+
+// Largest brightening a single triangle may contribute; keeps degenerate
+// triangles at focal points finite
+const float CAUSTICS_MAX_RATIO = 50.0f;
+
+// Where a ray from lightPos through the surface point lands on the bottom
+glm::vec3 projectToBottom(const glm::vec3& lightPos, const glm::vec3& surfacePoint,
+                          const glm::vec3& normal);
+
+// Bounds that hold all the light the current grid can put on the bottom:
+// the flat pool's refracted footprint, grown by the water depth, which
+// bounds how far a tilted surface moves a hit
+CausticsMapBounds poolCausticsBounds(const glm::vec3& lightPos);
+
+// CPU reference for the caustics pass: rasterizes every refracted surface
+// triangle into a mapWidth x mapHeight map covering bounds (row 0 at
+// bounds.min in y) and adds up the area ratios, like the additive GPU pass
+// does. alpha blends between the previous and current solver tick.
+void computeCausticsMap(std::vector<float>& map, int mapWidth, int mapHeight, const CausticsMapBounds& bounds,
+                        const glm::vec3& lightPos, float alpha = 1.0f);
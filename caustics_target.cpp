@@ -0,0 +1,98 @@
+#include "caustics_target.h"
+
+#include <iostream>
+#include <glad/glad.h>
+
+const char* causticsFormatName(CausticsFormat format) {
+    return format == CausticsFormat::R32F ? "R32F" : "R16F";
+}
+
+bool CausticsTarget::create(int width, int height, CausticsFormat format, bool mipmaps) {
+    destroy();
+    mapWidth = width;
+    mapHeight = height;
+    storageFormat = format;
+    useMipmaps = mipmaps;
+
+    glGenFramebuffers(1, &framebuffer);
+    glGenTextures(1, &colorTexture);
+    if (!allocate()) {
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void CausticsTarget::destroy() {
+    if (framebuffer) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &colorTexture);
+        framebuffer = colorTexture = 0;
+    }
+}
+
+bool CausticsTarget::resize(int width, int height) {
+    if (width == mapWidth && height == mapHeight) {
+        return true;
+    }
+    mapWidth = width;
+    mapHeight = height;
+    return allocate();
+}
+
+// (Re)creates the texture storage at the current size and attaches it
+bool CausticsTarget::allocate() {
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    GLint internalFormat = storageFormat == CausticsFormat::R32F ? GL_R32F : GL_R16F;
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, mapWidth, mapHeight, 0, GL_RED, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, useMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    GLenum buf = GL_COLOR_ATTACHMENT0;
+    glDrawBuffers(1, &buf);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (!complete) {
+        std::cerr << "Caustics FBO incomplete (" << causticsFormatName(storageFormat) << ", "
+                  << mapWidth << "x" << mapHeight << ")\n";
+    } else {
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Give every level defined contents before the first pass
+    if (complete && useMipmaps) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    return complete;
+}
+
+void CausticsTarget::begin() {
+    glGetIntegerv(GL_VIEWPORT, savedViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, mapWidth, mapHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void CausticsTarget::end() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+    if (useMipmaps) {
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+void CausticsTarget::download(std::vector<float>& values) const {
+    values.resize(static_cast<size_t>(mapWidth) * mapHeight);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glReadPixels(0, 0, mapWidth, mapHeight, GL_RED, GL_FLOAT, values.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+// Storage for the caustics map. The map has a single channel, so R16F
+// (2 bytes per texel) is enough for the additive light sums; R32F keeps
+// full precision for verification against the CPU reference.
+enum class CausticsFormat { R16F, R32F };
+
+const char* causticsFormatName(CausticsFormat format);
+
+// Render target the caustics pass accumulates into and the bottom pass
+// samples. Its size is independent of the window. With mipmaps enabled the
+// chain is rebuilt after every pass, so the bottom shader's filtered taps
+// stay smooth when the map is minified. Needs a current GL context.
+class CausticsTarget {
+public:
+    CausticsTarget() = default;
+    CausticsTarget(const CausticsTarget&) = delete;
+    CausticsTarget& operator=(const CausticsTarget&) = delete;
+
+    bool create(int width, int height, CausticsFormat format, bool mipmaps);
+    void destroy();
+
+    // Reallocates the storage if the size changed; the map is cleared
+    bool resize(int width, int height);
+
+    // Binds and clears the target and sets the viewport to cover it
+    void begin();
+    // Restores the default framebuffer and viewport and rebuilds mipmaps
+    void end();
+
+    // Reads level 0 back, one float per texel, row 0 first
+    void download(std::vector<float>& values) const;
+
+    unsigned int texture() const { return colorTexture; }
+    int width() const { return mapWidth; }
+    int height() const { return mapHeight; }
+    CausticsFormat format() const { return storageFormat; }
+    bool mipmaps() const { return useMipmaps; }
+
+private:
+    bool allocate();
+
+    unsigned int framebuffer = 0;
+    unsigned int colorTexture = 0;
+    int mapWidth = 0;
+    int mapHeight = 0;
+    CausticsFormat storageFormat = CausticsFormat::R16F;
+    bool useMipmaps = false;
+    int savedViewport[4] = {};
+};
@@ -0,0 +1,254 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+const char* framePassName(FramePass pass) {
+    switch (pass) {
+        case FramePass::Simulation: return "simulation";
+        case FramePass::Upload: return "upload";
+        case FramePass::Caustics: return "caustics";
+        case FramePass::CausticsFilter: return "filter";
+        case FramePass::Bottom: return "bottom";
+        case FramePass::Water: return "water";
+        case FramePass::Skybox: return "skybox";
+        default: return "unknown";
+    }
+}
+
+void RollingSamples::push(double value) {
+    values[next] = value;
+    next = (next + 1) % static_cast<int>(values.size());
+    filled = std::min(filled + 1, static_cast<int>(values.size()));
+}
+
+SampleStats RollingSamples::stats() const {
+    SampleStats result;
+    result.count = filled;
+    if (filled == 0) {
+        return result;
+    }
+
+    std::vector<double> sorted(values.begin(), values.begin() + filled);
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double v : sorted) {
+        sum += v;
+    }
+    // Nearest-rank percentiles
+    auto percentile = [&](double q) {
+        int rank = static_cast<int>(std::ceil(q * filled));
+        return sorted[std::min(std::max(rank, 1), filled) - 1];
+    };
+    result.mean = sum / filled;
+    result.p50 = percentile(0.50);
+    result.p95 = percentile(0.95);
+    result.p99 = percentile(0.99);
+    result.max = sorted.back();
+    return result;
+}
+
+bool FrameProfiler::create(bool useGpuTimers) {
+    destroy();
+    gpuTimers = useGpuTimers && glGenQueries && glBeginQuery;
+    if (gpuTimers) {
+        for (FrameSlot& slot : slots) {
+            glGenQueries(kPassCount, slot.queries);
+        }
+    }
+    frameIndex = -1;
+    droppedFrames = 0;
+    active = true;
+    return true;
+}
+
+void FrameProfiler::destroy() {
+    if (!active) {
+        return;
+    }
+    // Oldest frame first, so the trace stays in order
+    for (long long frame = frameIndex - kQueryFrames + 1; frame <= frameIndex; ++frame) {
+        if (frame >= 0 && slots[frame % kQueryFrames].frame == frame) {
+            collect(slots[frame % kQueryFrames], true);
+        }
+    }
+    if (gpuTimers) {
+        for (FrameSlot& slot : slots) {
+            glDeleteQueries(kPassCount, slot.queries);
+            std::fill(slot.queries, slot.queries + kPassCount, 0u);
+        }
+    }
+    if (trace.is_open()) {
+        trace.close();
+    }
+    active = false;
+}
+
+bool FrameProfiler::openTrace(const std::string& path) {
+    trace.open(path);
+    if (!trace) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    trace << "frame,frame_ms";
+    for (const char* clock : {"cpu", "gpu"}) {
+        for (int p = 0; p < kPassCount; ++p) {
+            trace << "," << clock << "_" << framePassName(FramePass(p)) << "_ms";
+        }
+    }
+    trace << "\n";
+    return true;
+}
+
+void FrameProfiler::beginFrame() {
+    Clock::time_point now = Clock::now();
+    if (frameIndex >= 0) {
+        FrameSlot& previous = slots[frameIndex % kQueryFrames];
+        previous.frameMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+        frameSamples.push(previous.frameMs);
+    }
+    ++frameIndex;
+    frameStart = now;
+
+    // The slot about to be reused was last filled kQueryFrames frames ago
+    FrameSlot& slot = slots[frameIndex % kQueryFrames];
+    if (slot.frame >= 0) {
+        collect(slot, false);
+    }
+    slot.frame = frameIndex;
+    slot.frameMs = 0.0;
+    std::fill(slot.cpuMs, slot.cpuMs + kPassCount, 0.0);
+    std::fill(slot.cpuTimed, slot.cpuTimed + kPassCount, false);
+    std::fill(slot.queried, slot.queried + kPassCount, false);
+}
+
+void FrameProfiler::endFrame() {
+    const FrameSlot& slot = slots[frameIndex % kQueryFrames];
+    for (int p = 0; p < kPassCount; ++p) {
+        if (slot.cpuTimed[p]) {
+            cpuSamples[p].push(slot.cpuMs[p]);
+        }
+    }
+}
+
+void FrameProfiler::beginPass(FramePass pass) {
+    const int p = int(pass);
+    FrameSlot& slot = slots[frameIndex % kQueryFrames];
+    // Time-elapsed queries cannot nest, and passes never overlap
+    if (gpuTimers) {
+        glBeginQuery(GL_TIME_ELAPSED, slot.queries[p]);
+        slot.queried[p] = true;
+    }
+    passStart[p] = Clock::now();
+}
+
+void FrameProfiler::endPass(FramePass pass) {
+    const int p = int(pass);
+    addCpuSample(pass, std::chrono::duration<double, std::milli>(Clock::now() - passStart[p]).count());
+    if (gpuTimers) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+}
+
+void FrameProfiler::addCpuSample(FramePass pass, double milliseconds) {
+    FrameSlot& slot = slots[frameIndex % kQueryFrames];
+    slot.cpuMs[int(pass)] += milliseconds;
+    slot.cpuTimed[int(pass)] = true;
+}
+
+// Reads back a frame's GPU times and writes its trace row. Without wait,
+// a frame whose queries are not all available yet loses its GPU times.
+void FrameProfiler::collect(FrameSlot& slot, bool wait) {
+    bool anyQueried = false;
+    bool ready = true;
+    for (int p = 0; p < kPassCount; ++p) {
+        if (!slot.queried[p]) {
+            continue;
+        }
+        anyQueried = true;
+        if (!wait) {
+            GLint available = 0;
+            glGetQueryObjectiv(slot.queries[p], GL_QUERY_RESULT_AVAILABLE, &available);
+            ready = ready && available;
+        }
+    }
+
+    double gpuMs[kPassCount] = {};
+    if (anyQueried && ready) {
+        for (int p = 0; p < kPassCount; ++p) {
+            if (slot.queried[p]) {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(slot.queries[p], GL_QUERY_RESULT, &nanoseconds);
+                gpuMs[p] = nanoseconds / 1e6;
+                gpuSamples[p].push(gpuMs[p]);
+            }
+        }
+    } else if (anyQueried) {
+        ++droppedFrames;
+    }
+
+    if (trace.is_open()) {
+        trace << slot.frame << ",";
+        if (slot.frameMs > 0.0) trace << slot.frameMs;
+        for (int p = 0; p < kPassCount; ++p) {
+            trace << ",";
+            if (slot.cpuTimed[p]) trace << slot.cpuMs[p];
+        }
+        for (int p = 0; p < kPassCount; ++p) {
+            trace << ",";
+            if (slot.queried[p] && ready) trace << gpuMs[p];
+        }
+        trace << "\n";
+    }
+    slot.frame = -1;
+}
+
+// Mean and percentiles as fixed-width columns, or dashes without samples
+static std::string statColumns(const SampleStats& stats) {
+    char text[64];
+    if (stats.count == 0) {
+        std::snprintf(text, sizeof(text), "%8s %8s %8s %8s", "-", "-", "-", "-");
+    } else {
+        std::snprintf(text, sizeof(text), "%8.3f %8.3f %8.3f %8.3f", stats.mean, stats.p50, stats.p95, stats.p99);
+    }
+    return text;
+}
+
+void FrameProfiler::printReport(std::ostream& out) const {
+    char line[160];
+    SampleStats frame = frameStats();
+    std::snprintf(line, sizeof(line), "Frame timing over %d frames (ms): mean %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f",
+                  frame.count, frame.mean, frame.p50, frame.p95, frame.p99, frame.max);
+    out << line << "\n";
+    std::snprintf(line, sizeof(line), "  %-11s %8s %8s %8s %8s   %8s %8s %8s %8s",
+                  "pass", "cpu mean", "p50", "p95", "p99", "gpu mean", "p50", "p95", "p99");
+    out << line << "\n";
+    for (int p = 0; p < kPassCount; ++p) {
+        SampleStats cpu = cpuSamples[p].stats();
+        SampleStats gpu = gpuSamples[p].stats();
+        if (cpu.count == 0 && gpu.count == 0) {
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "  %-11s %s   %s", framePassName(FramePass(p)),
+                      statColumns(cpu).c_str(), statColumns(gpu).c_str());
+        out << line << "\n";
+    }
+    if (droppedFrames > 0) {
+        out << "  " << droppedFrames << " frame(s) had GPU results too late to read without stalling\n";
+    }
+    out.flush();
+}
+
+std::string FrameProfiler::summary() const {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.2f ms", frameStats().mean);
+    std::string result = std::string("frame ") + text + " | cpu/gpu ms";
+    for (int p = 0; p < kPassCount; ++p) {
+        std::snprintf(text, sizeof(text), " %s %.2f/%.2f", framePassName(FramePass(p)),
+                      cpuSamples[p].stats().mean, gpuSamples[p].stats().mean);
+        result += text;
+    }
+    return result;
+}
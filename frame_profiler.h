@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// Stages of an interactive frame, in the order renderLoop() runs them
+enum class FramePass {
+    Simulation,  // Solver steps (the simulation thread's time in async mode)
+    Upload,      // Water mesh build and upload
+    Caustics,    // Caustics map into the FBO
+    CausticsFilter, // Caustics blur and temporal accumulation
+    Bottom,      // Pool bottom
+    Water,       // Water surface
+    Skybox,
+    Count
+};
+
+const char* framePassName(FramePass pass);
+
+// Summary of the samples in a RollingSamples window, in milliseconds
+struct SampleStats {
+    int count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Fixed-size window over the most recent samples
+class RollingSamples {
+public:
+    explicit RollingSamples(int capacity = 240) : values(capacity) {}
+
+    void push(double value);
+    SampleStats stats() const;
+
+private:
+    std::vector<double> values;
+    int next = 0;
+    int filled = 0;
+};
+
+// Per-pass frame timing. CPU time is measured with a steady clock around each
+// pass; GPU time with GL_TIME_ELAPSED queries. Each frame's queries are read
+// back kQueryFrames frames later, and only if the driver reports them
+// available, so the profiler never waits on the GPU. A frame whose results
+// are still pending is dropped from the GPU statistics instead.
+class FrameProfiler {
+public:
+    static constexpr int kQueryFrames = 2;
+
+    FrameProfiler() = default;
+    ~FrameProfiler() { destroy(); }
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // Enables the profiler; GPU timers need a current GL context
+    bool create(bool gpuTimers);
+    // Writes out pending frames (waiting for their queries) and frees them
+    void destroy();
+    bool enabled() const { return active; }
+
+    // Writes one CSV row per frame once its GPU times are known
+    bool openTrace(const std::string& path);
+
+    void beginFrame();
+    void endFrame();
+    void beginPass(FramePass pass);
+    void endPass(FramePass pass);
+    // CPU time for a pass that ran outside the render thread
+    void addCpuSample(FramePass pass, double milliseconds);
+
+    SampleStats frameStats() const { return frameSamples.stats(); }
+    SampleStats cpuStats(FramePass pass) const { return cpuSamples[int(pass)].stats(); }
+    SampleStats gpuStats(FramePass pass) const { return gpuSamples[int(pass)].stats(); }
+    long long droppedGpuFrames() const { return droppedFrames; }
+
+    // Table of rolling means and percentiles per pass
+    void printReport(std::ostream& out) const;
+    // One line of rolling means, short enough for a window title
+    std::string summary() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int kPassCount = int(FramePass::Count);
+
+    // Everything recorded for one frame while its queries are in flight
+    struct FrameSlot {
+        long long frame = -1;
+        double frameMs = 0.0;
+        double cpuMs[kPassCount] = {};
+        bool cpuTimed[kPassCount] = {};
+        GLuint queries[kPassCount] = {};
+        bool queried[kPassCount] = {};
+    };
+
+    void collect(FrameSlot& slot, bool wait);
+
+    bool active = false;
+    bool gpuTimers = false;
+    FrameSlot slots[kQueryFrames];
+    long long frameIndex = -1;
+    Clock::time_point frameStart;
+    Clock::time_point passStart[kPassCount];
+
+    RollingSamples frameSamples;
+    RollingSamples cpuSamples[kPassCount];
+    RollingSamples gpuSamples[kPassCount];
+    long long droppedFrames = 0;
+    std::ofstream trace;
+};
+
+// Times a pass for the lifetime of the object; does nothing while the
+// profiler is disabled
+class ScopedPassTimer {
+public:
+    ScopedPassTimer(FrameProfiler& profiler, FramePass pass) : profiler(profiler), pass(pass) {
+        if (profiler.enabled()) profiler.beginPass(pass);
+    }
+    ~ScopedPassTimer() {
+        if (profiler.enabled()) profiler.endPass(pass);
+    }
+    ScopedPassTimer(const ScopedPassTimer&) = delete;
+    ScopedPassTimer& operator=(const ScopedPassTimer&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    FramePass pass;
+};
@@ -0,0 +1,114 @@
+#include "gpu_simulation.h"
+
+#include <iostream>
+#include <glad/glad.h>
+
+bool GpuWaveSimulation::create(int rowCount, int colCount, unsigned int stepProgram) {
+    destroy();
+    rows = rowCount;
+    cols = colCount;
+    program = stepProgram;
+    base = 0;
+
+    glGenTextures(3, textures);
+    glGenFramebuffers(3, framebuffers);
+    for (int k = 0; k < 3; ++k) {
+        glBindTexture(GL_TEXTURE_2D, textures[k]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, cols, rows, 0, GL_RED, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[k]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[k], 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "GPU simulation FBO incomplete\n";
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            destroy();
+            return false;
+        }
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glGenVertexArrays(1, &emptyVAO);
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "currentHeights"), 0);
+    glUniform1i(glGetUniformLocation(program, "prevHeights"), 1);
+    keepLocation = glGetUniformLocation(program, "keep");
+    coeffLocation = glGetUniformLocation(program, "coeff");
+    return true;
+}
+
+void GpuWaveSimulation::destroy() {
+    if (textures[0]) {
+        glDeleteFramebuffers(3, framebuffers);
+        glDeleteTextures(3, textures);
+        glDeleteVertexArrays(1, &emptyVAO);
+        for (int k = 0; k < 3; ++k) {
+            textures[k] = framebuffers[k] = 0;
+        }
+        emptyVAO = 0;
+    }
+}
+
+void GpuWaveSimulation::upload(const HeightFieldRing& ring) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, ring.current().stride());
+    glBindTexture(GL_TEXTURE_2D, currentTexture());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, cols, rows, GL_RED, GL_FLOAT, ring.current().data());
+    glBindTexture(GL_TEXTURE_2D, prevTexture());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, cols, rows, GL_RED, GL_FLOAT, ring.prev().data());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void GpuWaveSimulation::download(HeightField& field) const {
+    if (field.rows() != rows || field.cols() != cols) {
+        field.resize(rows, cols);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[(base + 1) % 3]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glPixelStorei(GL_PACK_ROW_LENGTH, field.stride());
+    glReadPixels(0, 0, cols, rows, GL_RED, GL_FLOAT, field.data());
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GpuWaveSimulation::step(int steps, float keep, float coeff) {
+    if (steps <= 0) {
+        return;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glViewport(0, 0, cols, rows);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+
+    glUseProgram(program);
+    glUniform1f(keepLocation, keep);
+    glUniform1f(coeffLocation, coeff);
+    glBindVertexArray(emptyVAO);
+
+    for (int s = 0; s < steps; ++s) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[(base + 2) % 3]);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, currentTexture());
+        glActiveTexture(GL_TEXTURE0 + 1);
+        glBindTexture(GL_TEXTURE_2D, prevTexture());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        base = (base + 1) % 3;
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void GpuWaveSimulation::addDisturbance(int x, int y, float height) {
+    glBindTexture(GL_TEXTURE_2D, currentTexture());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, y, x, 1, 1, GL_RED, GL_FLOAT, &height);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "heightfield.h"
+
+// Wave solver that keeps the three time levels in R32F textures and steps
+// them with a full-screen fragment pass, so the height field never leaves
+// the GPU. Texel (x, y) holds grid cell (i = y, j = x), matching the row
+// layout of HeightField. Needs a current GL context.
+class GpuWaveSimulation {
+public:
+    GpuWaveSimulation() = default;
+    GpuWaveSimulation(const GpuWaveSimulation&) = delete;
+    GpuWaveSimulation& operator=(const GpuWaveSimulation&) = delete;
+
+    // stepProgram is the linked wave step shader (see waveStepFragmentShaderSource)
+    bool create(int rows, int cols, unsigned int stepProgram);
+    void destroy();
+
+    // Copies the previous and current CPU time levels to the GPU
+    void upload(const HeightFieldRing& ring);
+    // Reads the current time level back, for verification
+    void download(HeightField& field) const;
+
+    // Advances the simulation; restores the viewport afterwards
+    void step(int steps, float keep, float coeff);
+    void addDisturbance(int x, int y, float height);
+
+    unsigned int currentTexture() const { return textures[(base + 1) % 3]; }
+    unsigned int prevTexture() const { return textures[base]; }
+
+private:
+    int rows = 0;
+    int cols = 0;
+    unsigned int program = 0;
+    unsigned int textures[3] = {};
+    unsigned int framebuffers[3] = {};
+    unsigned int emptyVAO = 0;  // Core profile needs a VAO for attribute-less draws
+    int base = 0;               // Same rotation as HeightFieldRing: prev, current, next
+    int keepLocation = -1;
+    int coeffLocation = -1;
+};
@@ -0,0 +1,122 @@
+#include "headless.h"
+
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include "image_io.h"
+#include "photon_caustics.h"
+#include "ray_packet.h"
+#include "ray_tracing.h"
+#include "simulation.h"
+
+// Height field as a single-channel PFM; image rows follow the grid's first
+// index (x) and columns the second (y)
+static bool writeHeightFrame(const std::string& dir, int step) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "height_%06d.pfm", step);
+    std::string path = (std::filesystem::path(dir) / name).string();
+    const HeightField& field = heights.current();
+    return writePFM(path, field.data(), field.cols(), field.rows(), field.stride(), 1);
+}
+
+// Photon-traced caustics map of the current surface as a single-channel PFM
+static bool writeCausticsFrame(const HeadlessOptions& options, int step, PhotonCausticsStats& total) {
+    PhotonCausticsOptions photonOptions;
+    photonOptions.photons = options.photons;
+    photonOptions.mapWidth = photonOptions.mapHeight = options.causticsSize;
+    photonOptions.bounds = poolCausticsBounds(photonOptions.lightPos);
+    photonOptions.seed = static_cast<std::uint64_t>(step) + 1;
+
+    std::vector<float> map;
+    PhotonCausticsStats stats = tracePhotonCaustics(photonOptions, map);
+    total.photons += stats.photons;
+    total.landed += stats.landed;
+    total.seconds += stats.seconds;
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "caustics_%06d.pfm", step);
+    std::string path = (std::filesystem::path(options.outputDir) / name).string();
+    return writePFM(path, map.data(), options.causticsSize, options.causticsSize, options.causticsSize, 1);
+}
+
+int runHeadless(const HeadlessOptions& options) {
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+    if (ec) {
+        std::cerr << "Failed to create output directory " << options.outputDir
+                  << ": " << ec.message() << std::endl;
+        return -1;
+    }
+
+    init_grid();
+    add_initial_disturbances();
+
+    const int chunk = options.outputEvery > 0 ? options.outputEvery : options.steps;
+    double solveSeconds = 0.0;
+    PhotonCausticsStats photonTotal;
+    int step = 0;
+    while (step < options.steps) {
+        int count = std::min(chunk, options.steps - step);
+        auto start = std::chrono::steady_clock::now();
+        update_wave_steps(count);
+        solveSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        step += count;
+
+        if (!writeHeightFrame(options.outputDir, step)) {
+            return -1;
+        }
+        if (options.photons > 0 && !writeCausticsFrame(options, step, photonTotal)) {
+            return -1;
+        }
+    }
+
+    double cellUpdates = double(width - 2) * double(height - 2) * options.steps;
+    std::cout << "Simulated " << options.steps << " steps on a " << width << "x" << height
+              << " grid in " << solveSeconds << " s ("
+              << (solveSeconds > 0.0 ? cellUpdates / solveSeconds / 1e6 : 0.0)
+              << " M cell updates/s)" << std::endl;
+    if (!options.renderPath.empty()) {
+        Framebuffer framebuffer;
+        framebuffer.resize(options.renderWidth > 0 ? options.renderWidth : width,
+                           options.renderHeight > 0 ? options.renderHeight : height);
+        auto start = std::chrono::steady_clock::now();
+        RenderSettings settings;
+        if (options.renderLanes > 0) {
+            // Narrowest packet that fits the request, within what this CPU supports
+            for (SimdIsa isa : {SimdIsa::Scalar, SimdIsa::SSE, SimdIsa::AVX2, SimdIsa::AVX512}) {
+                if (isa <= detectSimdIsa()) {
+                    settings.packetIsa = isa;
+                }
+                if (packetLaneCount(isa) >= options.renderLanes) {
+                    break;
+                }
+            }
+        }
+        settings.marchHeightField = !options.renderPlane;
+        if (settings.marchHeightField) {
+            std::cout << "Ray tracer: height field marching with a min/max pyramid" << std::endl;
+        } else {
+            std::cout << "Ray tracer: z = 0 plane, " << packetLaneCount(settings.packetIsa) << " ray(s) per packet" << std::endl;
+        }
+        renderScene(framebuffer, settings);
+        double renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!writeFramebuffer(options.renderPath, framebuffer)) {
+            return -1;
+        }
+        double rays = double(framebuffer.imageWidth) * framebuffer.imageHeight;
+        std::cout << "Rendered " << framebuffer.imageWidth << "x" << framebuffer.imageHeight << " in "
+                  << renderSeconds << " s (" << (renderSeconds > 0.0 ? rays / renderSeconds / 1e6 : 0.0)
+                  << " M primary rays/s)" << std::endl;
+    }
+    if (photonTotal.photons > 0) {
+        std::cout << "Traced " << photonTotal.photons << " photons (" << photonTotal.landed
+                  << " landed) in " << photonTotal.seconds << " s ("
+                  << photonTotal.photonsPerSecond() / 1e6 << " M photons/s)" << std::endl;
+        const CausticsMapBounds bounds = poolCausticsBounds(PhotonCausticsOptions().lightPos);
+        std::cout << "Caustics maps cover x and y from " << bounds.min << " to " << bounds.min + bounds.size
+                  << " on the bottom plane" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+// Options for running the simulation without a window or GL context.
+// Grid size, thread count and blocking are taken from the simulation
+// parameters in simulation.h.
+struct HeadlessOptions {
+    int steps = 1000;             // Total time steps to simulate
+    int outputEvery = 0;          // Write a frame every N steps (0 = final frame only)
+    std::string outputDir = ".";  // Directory for the output files
+    long long photons = 0;        // Photons per caustics map (0 = no caustics)
+    int causticsSize = 512;       // Caustics map resolution (square)
+    std::string renderPath;       // Ray-traced image of the final state (.pfm or .ppm)
+    int renderWidth = 0;          // Render size; 0 uses the grid size
+    int renderHeight = 0;
+    int renderLanes = 0;          // Rays per packet (1, 4, 8, 16); 0 = widest supported
+    bool renderPlane = false;     // Trace against the z = 0 plane instead of the height field
+};
+
+// Runs the wave simulation on the CPU and writes height fields to disk as
+// PFM files named height_<step>.pfm, plus caustics_<step>.pfm photon maps
+// when photons are requested, and optionally a ray-traced render of the
+// final state. Never touches GLFW or GLAD.
+// Returns the process exit code.
+int runHeadless(const HeadlessOptions& options);
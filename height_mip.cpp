@@ -0,0 +1,281 @@
+#include "height_mip.h"
+
+#include <cmath>
+#include <limits>
+
+// Grid rows per parallel work item when rebuilding level 0
+static const int mipBandRows = 32;
+
+void HeightMinMaxMip::build(const HeightField& field) {
+    fieldRows = field.rows();
+    fieldCols = field.cols();
+    levelRows.clear();
+    levelCols.clear();
+    nodes.clear();
+
+    int rowCount = std::max(1, fieldRows - 1);
+    int colCount = std::max(1, fieldCols - 1);
+    for (;;) {
+        levelRows.push_back(rowCount);
+        levelCols.push_back(colCount);
+        nodes.emplace_back(static_cast<size_t>(rowCount) * colCount);
+        if (rowCount == 1 && colCount == 1) {
+            break;
+        }
+        rowCount = (rowCount + 1) / 2;
+        colCount = (colCount + 1) / 2;
+    }
+
+    update(field, GridRegion{0, fieldRows, 0, fieldCols});
+}
+
+void HeightMinMaxMip::update(const HeightField& field, GridRegion changed) {
+    if (field.rows() != fieldRows || field.cols() != fieldCols) {
+        build(field);
+        return;
+    }
+
+    // A vertex belongs to the (up to) four cells around it
+    int rowBegin = std::max(0, changed.rowBegin - 1);
+    int rowEnd = std::min(levelRows[0], changed.rowEnd);
+    int colBegin = std::max(0, changed.colBegin - 1);
+    int colEnd = std::min(levelCols[0], changed.colEnd);
+    if (rowBegin >= rowEnd || colBegin >= colEnd) {
+        return;
+    }
+
+    updateLevel0(field, rowBegin, rowEnd, colBegin, colEnd);
+    for (int level = 1; level < levels(); ++level) {
+        rowBegin /= 2;
+        colBegin /= 2;
+        rowEnd = (rowEnd + 1) / 2;
+        colEnd = (colEnd + 1) / 2;
+        updateLevel(level, rowBegin, rowEnd, colBegin, colEnd);
+    }
+}
+
+void HeightMinMaxMip::updateLevel0(const HeightField& field, int rowBegin, int rowEnd, int colBegin, int colEnd) {
+    std::vector<Range>& level0 = nodes[0];
+    const int cols = levelCols[0];
+    const int bandCount = (rowEnd - rowBegin + mipBandRows - 1) / mipBandRows;
+
+    solverPool().parallelFor(bandCount, [&](int band) {
+        int first = rowBegin + band * mipBandRows;
+        int last = std::min(first + mipBandRows, rowEnd);
+        for (int i = first; i < last; ++i) {
+            const float* top = field.row(i);
+            const float* bottom = field.row(i + 1);
+            Range* out = level0.data() + static_cast<size_t>(i) * cols;
+            for (int j = colBegin; j < colEnd; ++j) {
+                float low = std::min(std::min(top[j], top[j + 1]), std::min(bottom[j], bottom[j + 1]));
+                float high = std::max(std::max(top[j], top[j + 1]), std::max(bottom[j], bottom[j + 1]));
+                out[j] = {low, high};
+            }
+        }
+    });
+}
+
+void HeightMinMaxMip::updateLevel(int level, int rowBegin, int rowEnd, int colBegin, int colEnd) {
+    const std::vector<Range>& below = nodes[level - 1];
+    std::vector<Range>& out = nodes[level];
+    const int belowRows = levelRows[level - 1];
+    const int belowCols = levelCols[level - 1];
+    const int cols = levelCols[level];
+
+    for (int i = rowBegin; i < rowEnd; ++i) {
+        for (int j = colBegin; j < colEnd; ++j) {
+            Range range = below[static_cast<size_t>(2 * i) * belowCols + 2 * j];
+            for (int di = 0; di < 2; ++di) {
+                for (int dj = 0; dj < 2; ++dj) {
+                    int bi = 2 * i + di;
+                    int bj = 2 * j + dj;
+                    if (bi < belowRows && bj < belowCols) {
+                        const Range& child = below[static_cast<size_t>(bi) * belowCols + bj];
+                        range.low = std::min(range.low, child.low);
+                        range.high = std::max(range.high, child.high);
+                    }
+                }
+            }
+            out[static_cast<size_t>(i) * cols + j] = range;
+        }
+    }
+}
+
+void HeightMinMaxMip::refresh() {
+    const HeightField& field = heights.current();
+    GridRegion changed = takeChangedRegion();
+    if (field.rows() != fieldRows || field.cols() != fieldCols) {
+        build(field);
+    } else if (!changed.empty()) {
+        update(field, changed);
+    }
+}
+
+HeightMinMaxMip& surfaceMip() {
+    static HeightMinMaxMip mip;
+    return mip;
+}
+
+// Vertex normal used for shading: central differences inside the grid,
+// straight up on the border, matching the water mesh
+static glm::vec3 vertexNormal(int i, int j) {
+    if (i > 0 && i < width - 1 && j > 0 && j < height - 1) {
+        return getSurfaceNormal(i, j);
+    }
+    return glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+// Moller-Trumbore; returns the ray parameter and barycentrics of b and c
+static bool intersectTriangle(const glm::vec3& origin, const glm::vec3& direction,
+                              const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+                              float& t, float& u, float& v) {
+    glm::vec3 edge1 = b - a;
+    glm::vec3 edge2 = c - a;
+    glm::vec3 p = glm::cross(direction, edge2);
+    float det = glm::dot(edge1, p);
+    if (std::fabs(det) < 1e-12f) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+    glm::vec3 s = origin - a;
+    u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    glm::vec3 q = glm::cross(s, edge1);
+    v = glm::dot(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    t = glm::dot(edge2, q) * invDet;
+    return true;
+}
+
+// Tests the two triangles of cell (i, j) within [tMin, tMax]
+static bool intersectCell(int i, int j, const glm::vec3& origin, const glm::vec3& direction,
+                          float tMin, float tMax, float& tHit, glm::vec3& normal) {
+    const HeightField& field = heights.current();
+    glm::vec3 topLeft(float(i), float(j), field(i, j));
+    glm::vec3 topRight(float(i), float(j + 1), field(i, j + 1));
+    glm::vec3 bottomLeft(float(i + 1), float(j), field(i + 1, j));
+    glm::vec3 bottomRight(float(i + 1), float(j + 1), field(i + 1, j + 1));
+
+    bool found = false;
+    float t, u, v;
+    if (intersectTriangle(origin, direction, topLeft, bottomLeft, topRight, t, u, v) && t >= tMin && t <= tMax) {
+        tMax = tHit = t;
+        normal = vertexNormal(i, j) * (1.0f - u - v) + vertexNormal(i + 1, j) * u + vertexNormal(i, j + 1) * v;
+        found = true;
+    }
+    if (intersectTriangle(origin, direction, topRight, bottomLeft, bottomRight, t, u, v) && t >= tMin && t <= tMax) {
+        tHit = t;
+        normal = vertexNormal(i, j + 1) * (1.0f - u - v) + vertexNormal(i + 1, j) * u + vertexNormal(i + 1, j + 1) * v;
+        found = true;
+    }
+    if (found) {
+        normal = glm::normalize(normal);
+    }
+    return found;
+}
+
+// Ray parameter range inside the box [x0, x1] x [y0, y1] (any z)
+static bool clipToBox(const glm::vec3& origin, const glm::vec3& inverseDirection,
+                      float x0, float x1, float y0, float y1, float& tEnter, float& tExit) {
+    float tx0 = (x0 - origin.x) * inverseDirection.x;
+    float tx1 = (x1 - origin.x) * inverseDirection.x;
+    float ty0 = (y0 - origin.y) * inverseDirection.y;
+    float ty1 = (y1 - origin.y) * inverseDirection.y;
+    tEnter = std::max(std::min(tx0, tx1), std::min(ty0, ty1));
+    tExit = std::min(std::max(tx0, tx1), std::max(ty0, ty1));
+    return tEnter <= tExit;
+}
+
+bool intersectHeightField(const HeightMinMaxMip& mip, const glm::vec3& origin, const glm::vec3& direction,
+                          float tMin, float tMax, float& tHit, glm::vec3& normal) {
+    if (mip.levels() == 0) {
+        return false;
+    }
+
+    // Axis-parallel rays get a huge rather than infinite inverse, which
+    // keeps the slab test free of 0 * inf
+    const float huge = std::numeric_limits<float>::max();
+    glm::vec3 inverseDirection(
+        direction.x != 0.0f ? 1.0f / direction.x : huge,
+        direction.y != 0.0f ? 1.0f / direction.y : huge,
+        0.0f);
+
+    struct Node {
+        int level, i, j;
+        float tEnter, tExit;
+    };
+    Node stack[64 * 3];
+    int top = 0;
+
+    const int rootLevel = mip.levels() - 1;
+    float tEnter, tExit;
+    if (!clipToBox(origin, inverseDirection, 0.0f, float(mip.rows(0)), 0.0f, float(mip.cols(0)), tEnter, tExit)) {
+        return false;
+    }
+    stack[top++] = {rootLevel, 0, 0, std::max(tEnter, tMin), std::min(tExit, tMax)};
+
+    while (top > 0) {
+        Node current = stack[--top];
+        if (current.tEnter > current.tExit) {
+            continue;
+        }
+
+        // Skip the node if the ray's height over it misses the node's range
+        const HeightMinMaxMip::Range& range = mip.node(current.level, current.i, current.j);
+        float zEnter = origin.z + direction.z * current.tEnter;
+        float zExit = origin.z + direction.z * current.tExit;
+        if (std::max(zEnter, zExit) < range.low || std::min(zEnter, zExit) > range.high) {
+            continue;
+        }
+
+        if (current.level == 0) {
+            if (intersectCell(current.i, current.j, origin, direction, current.tEnter, current.tExit, tHit, normal)) {
+                return true; // Nodes are visited front to back, so this is the nearest hit
+            }
+            continue;
+        }
+
+        // Push the overlapping children, farthest first so the nearest is
+        // popped next
+        const int childLevel = current.level - 1;
+        const float cellSize = float(1 << childLevel);
+        Node children[4];
+        int childCount = 0;
+        for (int di = 0; di < 2; ++di) {
+            for (int dj = 0; dj < 2; ++dj) {
+                int ci = current.i * 2 + di;
+                int cj = current.j * 2 + dj;
+                if (ci >= mip.rows(childLevel) || cj >= mip.cols(childLevel)) {
+                    continue;
+                }
+                float x0 = ci * cellSize;
+                float x1 = std::min((ci + 1) * cellSize, float(mip.rows(0)));
+                float y0 = cj * cellSize;
+                float y1 = std::min((cj + 1) * cellSize, float(mip.cols(0)));
+                if (clipToBox(origin, inverseDirection, x0, x1, y0, y1, tEnter, tExit)) {
+                    tEnter = std::max(tEnter, current.tEnter);
+                    tExit = std::min(tExit, current.tExit);
+                    if (tEnter <= tExit) {
+                        children[childCount++] = {childLevel, ci, cj, tEnter, tExit};
+                    }
+                }
+            }
+        }
+        for (int c = 1; c < childCount; ++c) {
+            Node child = children[c];
+            int k = c;
+            for (; k > 0 && children[k - 1].tEnter < child.tEnter; --k) {
+                children[k] = children[k - 1];
+            }
+            children[k] = child;
+        }
+        for (int c = 0; c < childCount; ++c) {
+            stack[top++] = children[c];
+        }
+    }
+    return false;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include "heightfield.h"
+#include "simulation.h"
+
+// Min/max height pyramid over the cells of the water grid. Level 0 holds,
+// for every cell (the quad between vertices (i, j) and (i + 1, j + 1)), the
+// lowest and highest of its four corner heights; each level above combines
+// 2x2 nodes of the one below, up to a single root. A ray can skip any node
+// whose height range it passes above or below, so empty space is crossed
+// in O(log n) node visits instead of one step per cell.
+class HeightMinMaxMip {
+public:
+    struct Range {
+        float low;
+        float high;
+    };
+
+    // Sizes the pyramid for the field and builds it completely
+    void build(const HeightField& field);
+
+    // Recomputes the nodes covering a changed rectangle of vertices, from
+    // level 0 up to the root. Everything else is left as it was.
+    void update(const HeightField& field, GridRegion changed);
+
+    // Brings the pyramid up to date with heights.current(), rebuilding only
+    // what changed since the last refresh (see takeChangedRegion())
+    void refresh();
+
+    int levels() const { return static_cast<int>(levelRows.size()); }
+    int rows(int level) const { return levelRows[level]; }
+    int cols(int level) const { return levelCols[level]; }
+    const Range& node(int level, int i, int j) const {
+        return nodes[level][static_cast<size_t>(i) * levelCols[level] + j];
+    }
+
+private:
+    void updateLevel0(const HeightField& field, int rowBegin, int rowEnd, int colBegin, int colEnd);
+    void updateLevel(int level, int rowBegin, int rowEnd, int colBegin, int colEnd);
+
+    std::vector<int> levelRows;
+    std::vector<int> levelCols;
+    std::vector<std::vector<Range>> nodes;
+    int fieldRows = 0;
+    int fieldCols = 0;
+};
+
+// Pyramid for the simulation's height field, kept current by refresh()
+HeightMinMaxMip& surfaceMip();
+
+// Nearest intersection of a ray with the triangulated height field, in grid
+// space (x = row i, y = column j, z = height), using the same two triangles
+// per cell as the water mesh. Returns false if the ray misses; otherwise
+// sets t and the interpolated vertex normal at the hit.
+bool intersectHeightField(const HeightMinMaxMip& mip, const glm::vec3& origin, const glm::vec3& direction,
+                          float tMin, float tMax, float& t, glm::vec3& normal);
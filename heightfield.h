@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+
+// Flat, row-major 2D grid of floats used for the water height fields.
+// The whole grid is a single cache-line aligned allocation and every row is
+// padded to a whole number of cache lines, so row(i) always starts on a
+// cache line boundary and neighbouring rows are a fixed stride apart.
+class HeightField {
+public:
+    static constexpr std::size_t kAlignment = 64; // Cache line size in bytes
+    static constexpr int kRowAlign = static_cast<int>(kAlignment / sizeof(float));
+
+    HeightField() = default;
+    HeightField(int rows, int cols) { resize(rows, cols); }
+
+    HeightField(const HeightField& other) { *this = other; }
+    HeightField& operator=(const HeightField& other) {
+        if (this != &other) {
+            if (rows_ != other.rows_ || cols_ != other.cols_) {
+                resize(other.rows_, other.cols_);
+            }
+            if (size() > 0) {
+                std::memcpy(data_.get(), other.data_.get(), size() * sizeof(float));
+            }
+        }
+        return *this;
+    }
+    HeightField(HeightField&&) noexcept = default;
+    HeightField& operator=(HeightField&&) noexcept = default;
+
+    // Reallocate to rows x cols; contents are zeroed
+    void resize(int rows, int cols) {
+        rows_ = rows;
+        cols_ = cols;
+        stride_ = (cols + kRowAlign - 1) / kRowAlign * kRowAlign;
+        data_.reset();
+        if (size() > 0) {
+            void* p = ::operator new(size() * sizeof(float), std::align_val_t(kAlignment));
+            data_.reset(static_cast<float*>(p));
+        }
+        fill(0.0f);
+    }
+
+    // Fill every cell (including row padding) with a value
+    void fill(float value) {
+        std::fill(data_.get(), data_.get() + size(), value);
+    }
+
+    float& operator()(int i, int j) { return data_[static_cast<std::size_t>(i) * stride_ + j]; }
+    float operator()(int i, int j) const { return data_[static_cast<std::size_t>(i) * stride_ + j]; }
+
+    float* row(int i) { return data_.get() + static_cast<std::size_t>(i) * stride_; }
+    const float* row(int i) const { return data_.get() + static_cast<std::size_t>(i) * stride_; }
+
+    float* data() { return data_.get(); }
+    const float* data() const { return data_.get(); }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int stride() const { return stride_; } // Distance between rows in floats
+    std::size_t size() const { return static_cast<std::size_t>(rows_) * stride_; }
+
+private:
+    struct AlignedDelete {
+        void operator()(float* p) const { ::operator delete(p, std::align_val_t(kAlignment)); }
+    };
+
+    std::unique_ptr<float[], AlignedDelete> data_;
+    int rows_ = 0;
+    int cols_ = 0;
+    int stride_ = 0;
+};
+
+// The three time levels of the leapfrog wave solver. Rather than copying
+// grids at the end of every step, advance() rotates which buffer plays the
+// previous, current and next role, so a step costs only the stencil.
+class HeightFieldRing {
+public:
+    HeightFieldRing() = default;
+    HeightFieldRing(int rows, int cols) { resize(rows, cols); }
+
+    void resize(int rows, int cols) {
+        for (HeightField& field : fields_) {
+            field.resize(rows, cols);
+        }
+        base_ = 0;
+    }
+
+    HeightField& prev() { return fields_[base_]; }
+    HeightField& current() { return fields_[(base_ + 1) % 3]; }
+    HeightField& next() { return fields_[(base_ + 2) % 3]; }
+    const HeightField& prev() const { return fields_[base_]; }
+    const HeightField& current() const { return fields_[(base_ + 1) % 3]; }
+    const HeightField& next() const { return fields_[(base_ + 2) % 3]; }
+
+    // next becomes current, current becomes prev, and the old prev is
+    // recycled as the next write target
+    void advance() { base_ = (base_ + 1) % 3; }
+
+private:
+    HeightField fields_[3];
+    int base_ = 0;
+};
@@ -0,0 +1,65 @@
+#include "image_io.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+bool writePFM(const std::string& path, const float* data, int imageWidth, int imageHeight,
+              int stride, int channels) {
+    if (channels != 1 && channels != 3) {
+        std::cerr << "writePFM: unsupported channel count " << channels << std::endl;
+        return false;
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    // Negative scale marks little-endian data; PFM stores the bottom row first
+    std::fprintf(file, "%s\n%d %d\n-1.0\n", channels == 3 ? "PF" : "Pf", imageWidth, imageHeight);
+    std::vector<float> buffer(static_cast<size_t>(imageWidth) * channels * imageHeight);
+    float* out = buffer.data();
+    for (int y = imageHeight - 1; y >= 0; --y) {
+        const float* row = data + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < imageWidth * channels; ++x) {
+            *out++ = row[x];
+        }
+    }
+    size_t written = std::fwrite(buffer.data(), sizeof(float), buffer.size(), file);
+    bool ok = written == buffer.size();
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        std::cerr << "Failed to write " << path << std::endl;
+    }
+    return ok;
+}
+
+bool writePPM(const std::string& path, const float* data, int imageWidth, int imageHeight,
+              int stride) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    // PPM stores the top row first, like the memory layout
+    std::fprintf(file, "P6\n%d %d\n255\n", imageWidth, imageHeight);
+    std::vector<unsigned char> buffer(static_cast<size_t>(imageWidth) * 3 * imageHeight);
+    unsigned char* out = buffer.data();
+    for (int y = 0; y < imageHeight; ++y) {
+        const float* row = data + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < imageWidth * 3; ++x) {
+            float v = row[x] < 0.0f ? 0.0f : (row[x] > 1.0f ? 1.0f : row[x]);
+            *out++ = static_cast<unsigned char>(v * 255.0f + 0.5f);
+        }
+    }
+    size_t written = std::fwrite(buffer.data(), 1, buffer.size(), file);
+    bool ok = written == buffer.size();
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        std::cerr << "Failed to write " << path << std::endl;
+    }
+    return ok;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+// Writes a float image as a little-endian PFM file. channels must be 1
+// (grayscale "Pf") or 3 (RGB "PF"); rows are `stride` floats apart and are
+// stored top row first in memory. Returns false if the file can't be written.
+bool writePFM(const std::string& path, const float* data, int imageWidth, int imageHeight,
+              int stride, int channels);
+
+// Writes an RGB float image as a binary 8-bit PPM, clamping to [0, 1].
+// Same memory layout as writePFM with three channels.
+bool writePPM(const std::string& path, const float* data, int imageWidth, int imageHeight,
+              int stride);
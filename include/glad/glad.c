@@ -22,6 +22,10 @@ PFNGLDEPTHMASKPROC glad_glDepthMask = NULL;
 PFNGLDRAWBUFFERSPROC glad_glDrawBuffers = NULL;
 PFNGLREADBUFFERPROC glad_glReadBuffer = NULL;
 PFNGLDRAWARRAYSPROC glad_glDrawArrays = NULL;
+PFNGLGETINTEGERVPROC glad_glGetIntegerv = NULL;
+PFNGLPIXELSTOREIPROC glad_glPixelStorei = NULL;
+PFNGLREADPIXELSPROC glad_glReadPixels = NULL;
+PFNGLGETSTRINGIPROC glGetStringi = NULL;
 
 // Vertex Arrays
 PFNGLGENVERTEXARRAYSPROC glGenVertexArrays = NULL;
@@ -36,6 +40,22 @@ PFNGLBINDBUFFERPROC glBindBuffer = NULL;
 PFNGLBUFFERDATAPROC glBufferData = NULL;
 PFNGLBUFFERSUBDATAPROC glBufferSubData = NULL;
 PFNGLDELETEBUFFERSPROC glDeleteBuffers = NULL;
+PFNGLMAPBUFFERRANGEPROC glMapBufferRange = NULL;
+PFNGLUNMAPBUFFERPROC glUnmapBuffer = NULL;
+PFNGLBUFFERSTORAGEPROC glBufferStorage = NULL;
+
+// Sync objects
+PFNGLFENCESYNCPROC glFenceSync = NULL;
+PFNGLCLIENTWAITSYNCPROC glClientWaitSync = NULL;
+PFNGLDELETESYNCPROC glDeleteSync = NULL;
+
+// Queries
+PFNGLGENQUERIESPROC glGenQueries = NULL;
+PFNGLDELETEQUERIESPROC glDeleteQueries = NULL;
+PFNGLBEGINQUERYPROC glBeginQuery = NULL;
+PFNGLENDQUERYPROC glEndQuery = NULL;
+PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectiv = NULL;
+PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v = NULL;
 
 // Shaders
 PFNGLCREATESHADERPROC glCreateShader = NULL;
@@ -58,16 +78,24 @@ PFNGLDELETEPROGRAMPROC glDeleteProgram = NULL;
 PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation = NULL;
 PFNGLUNIFORM1IPROC glUniform1i = NULL;
 PFNGLUNIFORM1FPROC glUniform1f = NULL;
+PFNGLUNIFORM2FPROC glUniform2f = NULL;
+PFNGLUNIFORM1FVPROC glUniform1fv = NULL;
 PFNGLUNIFORM3FVPROC glUniform3fv = NULL;
 PFNGLUNIFORMMATRIX4FVPROC glUniformMatrix4fv = NULL;
+PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndex = NULL;
+PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBinding = NULL;
+PFNGLBINDBUFFERBASEPROC glBindBufferBase = NULL;
 
 // Textures
 PFNGLGENTEXTURESPROC glGenTextures = NULL;
 PFNGLBINDTEXTUREPROC glBindTexture = NULL;
 PFNGLTEXIMAGE2DPROC glTexImage2D = NULL;
 PFNGLTEXPARAMETERIPROC glTexParameteri = NULL;
+PFNGLTEXSUBIMAGE2DPROC glTexSubImage2D = NULL;
 PFNGLACTIVETEXTUREPROC glActiveTexture = NULL;
 PFNGLDELETETEXTURESPROC glDeleteTextures = NULL;
+PFNGLGENERATEMIPMAPPROC glGenerateMipmap = NULL;
+PFNGLMULTIDRAWELEMENTSBASEVERTEXPROC glMultiDrawElementsBaseVertex = NULL;
 
 // Framebuffers
 PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers = NULL;
@@ -84,6 +112,11 @@ static void* get_proc(GLADloadproc load, const char *name) {
     return proc;
 }
 
+// For entry points beyond the GL 3.3 baseline; callers check for NULL
+static void* get_optional_proc(GLADloadproc load, const char *name) {
+    return load(name);
+}
+
 int gladLoadGLLoader(GLADloadproc load) {
     if (!load) {
         return 0;
@@ -102,6 +135,10 @@ int gladLoadGLLoader(GLADloadproc load) {
     glad_glDrawBuffers = (PFNGLDRAWBUFFERSPROC)get_proc(load, "glDrawBuffers");
     glad_glReadBuffer = (PFNGLREADBUFFERPROC)get_proc(load, "glReadBuffer");
     glad_glDrawArrays = (PFNGLDRAWARRAYSPROC)get_proc(load, "glDrawArrays");
+    glad_glGetIntegerv = (PFNGLGETINTEGERVPROC)get_proc(load, "glGetIntegerv");
+    glad_glPixelStorei = (PFNGLPIXELSTOREIPROC)get_proc(load, "glPixelStorei");
+    glad_glReadPixels = (PFNGLREADPIXELSPROC)get_proc(load, "glReadPixels");
+    glGetStringi = (PFNGLGETSTRINGIPROC)get_proc(load, "glGetStringi");
 
     // Vertex Arrays
     glGenVertexArrays = (PFNGLGENVERTEXARRAYSPROC)get_proc(load, "glGenVertexArrays");
@@ -116,6 +153,22 @@ int gladLoadGLLoader(GLADloadproc load) {
     glBufferData = (PFNGLBUFFERDATAPROC)get_proc(load, "glBufferData");
     glBufferSubData = (PFNGLBUFFERSUBDATAPROC)get_proc(load, "glBufferSubData");
     glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)get_proc(load, "glDeleteBuffers");
+    glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)get_proc(load, "glMapBufferRange");
+    glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)get_proc(load, "glUnmapBuffer");
+    glBufferStorage = (PFNGLBUFFERSTORAGEPROC)get_optional_proc(load, "glBufferStorage");
+
+    // Sync objects
+    glFenceSync = (PFNGLFENCESYNCPROC)get_proc(load, "glFenceSync");
+    glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)get_proc(load, "glClientWaitSync");
+    glDeleteSync = (PFNGLDELETESYNCPROC)get_proc(load, "glDeleteSync");
+
+    // Queries
+    glGenQueries = (PFNGLGENQUERIESPROC)get_proc(load, "glGenQueries");
+    glDeleteQueries = (PFNGLDELETEQUERIESPROC)get_proc(load, "glDeleteQueries");
+    glBeginQuery = (PFNGLBEGINQUERYPROC)get_proc(load, "glBeginQuery");
+    glEndQuery = (PFNGLENDQUERYPROC)get_proc(load, "glEndQuery");
+    glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)get_proc(load, "glGetQueryObjectiv");
+    glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)get_proc(load, "glGetQueryObjectui64v");
 
     // Shaders
     glCreateShader = (PFNGLCREATESHADERPROC)get_proc(load, "glCreateShader");
@@ -138,16 +191,24 @@ int gladLoadGLLoader(GLADloadproc load) {
     glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)get_proc(load, "glGetUniformLocation");
     glUniform1i = (PFNGLUNIFORM1IPROC)get_proc(load, "glUniform1i");
     glUniform1f = (PFNGLUNIFORM1FPROC)get_proc(load, "glUniform1f");
+    glUniform2f = (PFNGLUNIFORM2FPROC)get_proc(load, "glUniform2f");
+    glUniform1fv = (PFNGLUNIFORM1FVPROC)get_proc(load, "glUniform1fv");
     glUniform3fv = (PFNGLUNIFORM3FVPROC)get_proc(load, "glUniform3fv");
     glUniformMatrix4fv = (PFNGLUNIFORMMATRIX4FVPROC)get_proc(load, "glUniformMatrix4fv");
+    glGetUniformBlockIndex = (PFNGLGETUNIFORMBLOCKINDEXPROC)get_proc(load, "glGetUniformBlockIndex");
+    glUniformBlockBinding = (PFNGLUNIFORMBLOCKBINDINGPROC)get_proc(load, "glUniformBlockBinding");
+    glBindBufferBase = (PFNGLBINDBUFFERBASEPROC)get_proc(load, "glBindBufferBase");
 
     // Textures
     glGenTextures = (PFNGLGENTEXTURESPROC)get_proc(load, "glGenTextures");
     glBindTexture = (PFNGLBINDTEXTUREPROC)get_proc(load, "glBindTexture");
     glTexImage2D = (PFNGLTEXIMAGE2DPROC)get_proc(load, "glTexImage2D");
     glTexParameteri = (PFNGLTEXPARAMETERIPROC)get_proc(load, "glTexParameteri");
+    glTexSubImage2D = (PFNGLTEXSUBIMAGE2DPROC)get_proc(load, "glTexSubImage2D");
     glActiveTexture = (PFNGLACTIVETEXTUREPROC)get_proc(load, "glActiveTexture");
     glDeleteTextures = (PFNGLDELETETEXTURESPROC)get_proc(load, "glDeleteTextures");
+    glGenerateMipmap = (PFNGLGENERATEMIPMAPPROC)get_proc(load, "glGenerateMipmap");
+    glMultiDrawElementsBaseVertex = (PFNGLMULTIDRAWELEMENTSBASEVERTEXPROC)get_proc(load, "glMultiDrawElementsBaseVertex");
 
     // Framebuffers
     glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)get_proc(load, "glGenFramebuffers");
@@ -2,45 +2,90 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <random>
 #include <glad/glad.h>
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "simulation.h"
+#include "headless.h"
+#include "water_mesh.h"
+#include "water_chunks.h"
+#include "triple_buffer.h"
+#include "stream_buffer.h"
+#include "gpu_simulation.h"
+#include "caustics_map.h"
+#include "ray_tracing.h"
+#include "frame_profiler.h"
+#include "caustics_target.h"
+#include "caustics_filter.h"
 
 using namespace std;
 
-// Water simulation parameters
-int width = 200;
-int height = 200;
-float dx = 1.0f;        // Grid spacing
-float dt = 0.7f;        // Time step
-float c = 1.0f;         // Wave speed
-float damping = 0.01f;  // Damping factor
-float waterScale = 2.0f; // Scale factor for water surface size
-
-// Water height grids for simulation
-std::vector<std::vector<float>> height_current(width, std::vector<float>(height));
-std::vector<std::vector<float>> height_prev(width, std::vector<float>(height));
-std::vector<std::vector<float>> height_next(width, std::vector<float>(height));
-
-// Physical constants
-const float WATER_IOR = 1.33f;  // Index of refraction for water
-const float AIR_IOR = 1.0f;     // Index of refraction for air
-
 // OpenGL window dimensions
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// Linked shader program with the locations of the uniforms the renderer
+// sets, looked up once by createShaderProgram() instead of by name per draw.
+// Uniforms a program does not use stay at -1, which glUniform ignores.
+struct ShaderProgram {
+    unsigned int id = 0;
+    GLint model = -1;
+    GLint alpha = -1;
+    GLint gridSpacing = -1;
+    GLint heightMap = -1;
+    GLint prevHeightMap = -1;
+    GLint causticsTexture = -1;
+    GLint causticsBaseline = -1;
+    GLint filteredCaustics = -1;
+    GLint bottomZ = -1;
+    GLint waterIOR = -1;
+    GLint airIOR = -1;
+    GLint causticsRange = -1;
+    GLint maxRatio = -1;
+};
+
+// Per-frame constants shared by all programs through one std140 uniform
+// buffer. FRAME_UNIFORMS_GLSL declares the same block for the shaders;
+// lightPos and viewPos each fill a 16-byte slot together with the float
+// after them.
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 lightPos;
+    float time;
+    glm::vec3 viewPos;
+    float padding;
+};
+static_assert(sizeof(FrameUniforms) == 160, "FrameUniforms must match the std140 block layout");
+
+#define FRAME_UNIFORMS_GLSL \
+    "    layout (std140) uniform FrameUniforms {\n" \
+    "        mat4 view;\n" \
+    "        mat4 projection;\n" \
+    "        vec3 lightPos;\n" \
+    "        float time;\n" \
+    "        vec3 viewPos;\n" \
+    "    };\n"
+
+const unsigned int FRAME_UNIFORMS_BINDING = 0;
+
 // Function prototypes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
-unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource);
-void setupCausticsFBO();
+ShaderProgram createShaderProgram(const char* vertexSource, const char* fragmentSource);
+bool setupCausticsTarget();
 
 // Shader sources
 const char* vertexShaderSource = R"(
@@ -102,16 +147,14 @@ const char* fragmentShaderSource = R"(
 
 const char* skyboxVertexShaderSource = R"(
     #version 330 core
+)" FRAME_UNIFORMS_GLSL R"(
     layout (location = 0) in vec3 aPos;
     
     out vec3 TexCoords;
     
-    uniform mat4 projection;
-    uniform mat4 view;
-    
     void main() {
         TexCoords = aPos;
-        vec4 pos = projection * view * vec4(aPos, 1.0);
+        vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0); // Rotation only
         gl_Position = pos.xyww; // Ensure z is 1.0 for skybox to be infinitely far
     }
 )";
@@ -133,18 +176,18 @@ const char* skyboxFragmentShaderSource = R"(
 // Add after other shader sources
 const char* causticsVertexShaderSource = R"(
     #version 330 core
-    layout (location = 0) in vec3 aPos;
-    layout (location = 1) in vec3 aNormal;
+)" FRAME_UNIFORMS_GLSL R"(
+    layout (location = 0) in vec2 aPosXY;   // Static grid position
+    layout (location = 1) in vec3 aNormal;  // Dynamic, packed 10:10:10:2
+    layout (location = 2) in float aHeight; // Dynamic
     
     out vec3 FragPos;
     out vec3 Normal;
     
     uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
     
     void main() {
-        FragPos = vec3(model * vec4(aPos, 1.0));
+        FragPos = vec3(model * vec4(aPosXY, aHeight, 1.0));
         Normal = mat3(transpose(inverse(model))) * aNormal;
         gl_Position = projection * view * vec4(FragPos, 1.0);
     }
@@ -152,16 +195,15 @@ const char* causticsVertexShaderSource = R"(
 
 const char* causticsFragmentShaderSource = R"(
     #version 330 core
+)" FRAME_UNIFORMS_GLSL R"(
     in vec3 FragPos;
     in vec3 Normal;
     
     out vec4 FragColor;
     
-    uniform vec3 lightPos;
     uniform float bottomZ;
     uniform float waterIOR;
     uniform float airIOR;
-    uniform float time;
     
     void main() {
         vec3 norm = normalize(Normal);
@@ -191,13 +233,14 @@ const char* causticsFragmentShaderSource = R"(
         causticIntensity = clamp(causticIntensity, 0.0, 1.0);
         
         // Output the caustic intensity
-        FragColor = vec4(0.0, 0.0, 0.0, causticIntensity);
+        FragColor = vec4(causticIntensity, 0.0, 0.0, 0.0);
     }
 )";
 
 // Bottom surface shader
 const char* bottomVertexShaderSource = R"(
     #version 330 core
+)" FRAME_UNIFORMS_GLSL R"(
     layout (location = 0) in vec3 aPos;
     layout (location = 1) in vec3 aNormal;
     
@@ -205,8 +248,6 @@ const char* bottomVertexShaderSource = R"(
     out vec3 Normal;
     
     uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
     
     void main() {
         FragPos = vec3(model * vec4(aPos, 1.0));
@@ -217,13 +258,16 @@ const char* bottomVertexShaderSource = R"(
 
 const char* bottomFragmentShaderSource = R"(
     #version 330 core
+)" FRAME_UNIFORMS_GLSL R"(
     in vec3 FragPos;
     in vec3 Normal;
     
     out vec4 FragColor;
     
     uniform sampler2D causticsTexture;
-    uniform float time;
+    uniform float causticsBaseline; // Map value that means no extra light
+    uniform bool filteredCaustics;  // Map is already blurred and accumulated
+    uniform vec2 causticsRange;     // Map origin and size on the bottom plane
     
     void main() {
         // Create a pool-style grid pattern
@@ -239,17 +283,23 @@ const char* bottomFragmentShaderSource = R"(
         vec3 finalColor = mix(baseColor, gridColor, gridLine * 0.4);
         
         // Sample caustics directly from the water surface position
-        vec2 causticsUV = (FragPos.xy + vec2(200.0)) / 400.0;
-        float causticIntensity = texture(causticsTexture, causticsUV).a;
-        
-        // Add multiple caustic layers with slight offsets for complexity
-        vec2 offset1 = vec2(sin(time * 0.3) * 0.02, cos(time * 0.4) * 0.02);
-        vec2 offset2 = vec2(cos(time * 0.7) * 0.03, sin(time * 0.6) * 0.03);
+        vec2 causticsUV = (FragPos.xy - causticsRange.x) / causticsRange.y;
+        float causticIntensity = texture(causticsTexture, causticsUV).r - causticsBaseline;
         
-        float caustic1 = texture(causticsTexture, causticsUV + offset1).a;
-        float caustic2 = texture(causticsTexture, causticsUV + offset2).a * 0.7;
-        
-        float totalCaustics = (causticIntensity + caustic1 + caustic2) * 2.5;
+        float totalCaustics;
+        if (filteredCaustics) {
+            // One tap, weighted like the three layers below
+            totalCaustics = causticIntensity * 2.7 * 2.5;
+        } else {
+            // Add multiple caustic layers with slight offsets for complexity
+            vec2 offset1 = vec2(sin(time * 0.3) * 0.02, cos(time * 0.4) * 0.02);
+            vec2 offset2 = vec2(cos(time * 0.7) * 0.03, sin(time * 0.6) * 0.03);
+            
+            float caustic1 = texture(causticsTexture, causticsUV + offset1).r - causticsBaseline;
+            float caustic2 = (texture(causticsTexture, causticsUV + offset2).r - causticsBaseline) * 0.7;
+            
+            totalCaustics = (causticIntensity + caustic1 + caustic2) * 2.5;
+        }
         
         // Apply caustics with bright, warm light
         vec3 causticColor = vec3(1.5, 1.2, 0.9); // Bright warm light
@@ -265,18 +315,18 @@ const char* bottomFragmentShaderSource = R"(
 // Water surface shader
 const char* waterVertexShaderSource = R"(
     #version 330 core
-    layout (location = 0) in vec3 aPos;
-    layout (location = 1) in vec3 aNormal;
+)" FRAME_UNIFORMS_GLSL R"(
+    layout (location = 0) in vec2 aPosXY;   // Static grid position
+    layout (location = 1) in vec3 aNormal;  // Dynamic, packed 10:10:10:2
+    layout (location = 2) in float aHeight; // Dynamic
     
     out vec3 FragPos;
     out vec3 Normal;
     
     uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
     
     void main() {
-        FragPos = vec3(model * vec4(aPos, 1.0));
+        FragPos = vec3(model * vec4(aPosXY, aHeight, 1.0));
         Normal = mat3(transpose(inverse(model))) * aNormal;
         gl_Position = projection * view * vec4(FragPos, 1.0);
     }
@@ -284,14 +334,12 @@ const char* waterVertexShaderSource = R"(
 
 const char* waterFragmentShaderSource = R"(
     #version 330 core
+)" FRAME_UNIFORMS_GLSL R"(
     in vec3 FragPos;
     in vec3 Normal;
     
     out vec4 FragColor;
     
-    uniform vec3 lightPos;
-    uniform vec3 viewPos;
-    
     void main() {
         // Standard Phong lighting
         vec3 N = normalize(Normal);
@@ -314,129 +362,295 @@ const char* waterFragmentShaderSource = R"(
     }
 )";
 
+// Water surface lookups shared by vertex shaders. Each variant defines
+// waterSurface(), returning the world-space position and normal of the
+// current vertex; a shader main() is appended to one of them.
 
+// Heights and packed normals streamed per vertex
+const char* streamedSurfaceShaderSource = R"(
+    #version 330 core
+)" FRAME_UNIFORMS_GLSL R"(
+    layout (location = 0) in vec2 aPosXY;   // Static grid position
+    layout (location = 1) in vec3 aNormal;  // Dynamic, packed 10:10:10:2
+    layout (location = 2) in float aHeight; // Dynamic
+    
+    uniform mat4 model;
+    
+    void waterSurface(out vec3 position, out vec3 normal) {
+        position = vec3(model * vec4(aPosXY, aHeight, 1.0));
+        normal = mat3(transpose(inverse(model))) * aNormal;
+    }
+)";
 
-// Global variables
-GLFWwindow* window;
-unsigned int waterVAO, waterVBO, waterEBO;
-unsigned int bottomVAO, bottomVBO, bottomEBO;
-unsigned int skyboxVAO, skyboxVBO;
-unsigned int causticsFBO, causticsTexture;
-unsigned int waterShaderProgram;
-unsigned int skyboxShaderProgram;
-unsigned int causticsShaderProgram;
-unsigned int bottomShaderProgram;
+// Displaced renderer: heights come from a height texture (the GPU solver's
+// own, or one uploaded from the CPU) and normals are rebuilt from central
+// differences, the same way getSurfaceNormal() does on the CPU
+const char* heightTextureSurfaceShaderSource = R"(
+    #version 330 core
+)" FRAME_UNIFORMS_GLSL R"(
+    layout (location = 0) in vec2 aPosXY;
+    
+    uniform mat4 model;
+    uniform sampler2D heightMap;     // Current time level, texel (j, i)
+    uniform sampler2D prevHeightMap; // Previous time level
+    uniform float alpha;             // Blend between previous and current
+    uniform float gridSpacing;
+    
+    float heightAt(ivec2 p) {
+        return mix(texelFetch(prevHeightMap, p, 0).r, texelFetch(heightMap, p, 0).r, alpha);
+    }
+    
+    void waterSurface(out vec3 position, out vec3 normal) {
+        ivec2 size = textureSize(heightMap, 0);
+        ivec2 p = ivec2(gl_VertexID % size.x, gl_VertexID / size.x);
+        
+        normal = vec3(0.0, 0.0, 1.0); // Default normal for edges
+        if (p.x > 0 && p.y > 0 && p.x < size.x - 1 && p.y < size.y - 1) {
+            float ddx = (heightAt(p + ivec2(0, 1)) - heightAt(p - ivec2(0, 1))) / (2.0 * gridSpacing);
+            float ddy = (heightAt(p + ivec2(1, 0)) - heightAt(p - ivec2(1, 0))) / (2.0 * gridSpacing);
+            normal = normalize(vec3(-ddx, -ddy, 1.0));
+        }
+        
+        position = vec3(model * vec4(aPosXY, heightAt(p), 1.0));
+        normal = mat3(transpose(inverse(model))) * normal;
+    }
+)";
 
-const float BOTTOM_Z = -30.0f; // Bottom surface Z coordinate (deeper for larger scale)
+// Water and stylized caustics vertex shader for the displaced renderer
+const char* displacedWaterVertexShaderSource = R"(
+    out vec3 FragPos;
+    out vec3 Normal;
+    
+    void main() {
+        waterSurface(FragPos, Normal);
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+    }
+)";
 
-std::vector<float> waterVertices;
-std::vector<unsigned int> waterIndices;
+// Physically based caustics: refracts the light through each water vertex
+// and rasterizes the surface where it lands on the bottom. The map covers
+// the bottom plane directly (see caustics_map.h), not the camera view.
+const char* physicalCausticsVertexShaderSource = R"(
+    out vec3 restHit; // Where the light lands under flat water
+    out vec3 litHit;  // Where it lands through the current surface
+    
+    uniform float bottomZ;
+    uniform float waterIOR;
+    uniform float airIOR;
+    uniform vec2 causticsRange; // Map origin and size on the bottom plane
+    
+    vec3 projectToBottom(vec3 point, vec3 normal) {
+        vec3 incident = normalize(point - lightPos);
+        vec3 refracted = refract(incident, normalize(normal), airIOR / waterIOR);
+        return point + refracted * ((bottomZ - point.z) / refracted.z);
+    }
+    
+    void main() {
+        vec3 position;
+        vec3 normal;
+        waterSurface(position, normal);
+        
+        restHit = projectToBottom(vec3(position.xy, 0.0), vec3(0.0, 0.0, 1.0));
+        litHit = projectToBottom(position, normal);
+        gl_Position = vec4((litHit.xy - causticsRange.x) / causticsRange.y * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
 
-// Add Ray struct for GLM
-struct Ray {
-    glm::vec3 origin;
-    glm::vec3 direction;
-    Ray(const glm::vec3& o, const glm::vec3& d) : origin(o), direction(glm::normalize(d)) {}
-};
+const char* physicalCausticsFragmentShaderSource = R"(
+    #version 330 core
+    in vec3 restHit;
+    in vec3 litHit;
+    
+    out vec4 FragColor;
+    
+    uniform float maxRatio;
+    
+    void main() {
+        // Both hit points are linear across the triangle, so their screen
+        // derivatives give the exact area ratio of the light mapping
+        float restArea = length(cross(dFdx(restHit), dFdy(restHit)));
+        float litArea = length(cross(dFdx(litHit), dFdy(litHit)));
+        float ratio = restArea / max(litArea, restArea / maxRatio);
+        
+        // Accumulated additively; 1 is the light of undisturbed water
+        FragColor = vec4(ratio, 0.0, 0.0, 0.0);
+    }
+)";
 
-// fluid simulation logic
-void update_wave(){
-    for (int i = 1; i < width - 1; ++i){
-        for (int j = 1; j < height - 1; ++j){
-            float laplacian =
-                height_current[i + 1][j] +
-                height_current[i - 1][j] +
-                height_current[i][j + 1] +
-                height_current[i][j - 1] -
-                4 * height_current[i][j];
-
-            // Update using the wave equation
-            height_next[i][j] = (1 - damping) * (2 * height_current[i][j] - height_prev[i][j]) +
-                                (c * c * dt * dt / (dx * dx)) * laplacian;
-        }
+// Pool bottom drawn with the static water grid, flattened to the bottom plane
+const char* gridBottomVertexShaderSource = R"(
+    #version 330 core
+)" FRAME_UNIFORMS_GLSL R"(
+    layout (location = 0) in vec2 aPosXY;
+    
+    out vec3 FragPos;
+    out vec3 Normal;
+    
+    uniform mat4 model;
+    uniform float bottomZ;
+    
+    void main() {
+        FragPos = vec3(model * vec4(aPosXY, bottomZ, 1.0));
+        Normal = mat3(transpose(inverse(model))) * vec3(0.0, 0.0, 1.0);
+        gl_Position = projection * view * vec4(FragPos, 1.0);
     }
+)";
 
-    // Swap buffers
-    height_prev = height_current;
-    height_current = height_next;
-}
+// Full-screen triangle for GPU simulation and caustics filter passes
+const char* fullscreenVertexShaderSource = R"(
+    #version 330 core
+    void main() {
+        vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
 
-void add_disturbance(int x, int y, float height){
-    height_current[x][y] = height;
-}
+// One wave equation step per texel, same arithmetic as the CPU row kernels;
+// the grid border is held at zero
+const char* waveStepFragmentShaderSource = R"(
+    #version 330 core
+    out float nextHeight;
+    
+    uniform sampler2D currentHeights;
+    uniform sampler2D prevHeights;
+    uniform float keep;   // 1 - damping
+    uniform float coeff;  // c^2 dt^2 / dx^2
+    
+    void main() {
+        ivec2 p = ivec2(gl_FragCoord.xy);
+        ivec2 size = textureSize(currentHeights, 0);
+        if (p.x == 0 || p.y == 0 || p.x == size.x - 1 || p.y == size.y - 1) {
+            nextHeight = 0.0;
+            return;
+        }
+        
+        float mid = texelFetch(currentHeights, p, 0).r;
+        float laplacian =
+            texelFetch(currentHeights, p + ivec2(0, 1), 0).r +
+            texelFetch(currentHeights, p - ivec2(0, 1), 0).r +
+            texelFetch(currentHeights, p + ivec2(1, 0), 0).r +
+            texelFetch(currentHeights, p - ivec2(1, 0), 0).r -
+            4.0 * mid;
+        
+        nextHeight = keep * (2.0 * mid - texelFetch(prevHeights, p, 0).r) + coeff * laplacian;
+    }
+)";
 
-void init_grid(){
-    for(int i = 0; i < width; i++){
-        for(int j = 0; j < height; j++){
-            height_current[i][j] = 0.0f;
+// One direction of the separable Gaussian caustics blur. Taps are spaced in
+// output texels, so the first pass also resamples the full-size map.
+const char* causticsBlurFragmentShaderSource = R"(
+    #version 330 core
+    out float filtered;
+    
+    uniform sampler2D sourceMap;
+    uniform vec2 outputScale;  // 1 / output size
+    uniform vec2 texelStep;    // One output texel along the blur direction
+    uniform int radius;
+    uniform float weights[17]; // CausticsFilter::kMaxBlurRadius + 1
+    
+    void main() {
+        vec2 uv = gl_FragCoord.xy * outputScale;
+        float sum = weights[0] * texture(sourceMap, uv).r;
+        for (int k = 1; k <= radius; ++k) {
+            vec2 offset = texelStep * float(k);
+            sum += weights[k] * (texture(sourceMap, uv + offset).r + texture(sourceMap, uv - offset).r);
         }
+        filtered = sum;
     }
-}
+)";
 
-// Function to get surface normal at a point
-glm::vec3 getSurfaceNormal(int x, int y) {
-    float ddx = (height_current[x+1][y] - height_current[x-1][y]) / (2.0f * dx);
-    float ddy = (height_current[x][y+1] - height_current[x][y-1]) / (2.0f * dx);
-    glm::vec3 n(-ddx, -ddy, 1.0f);
-    return glm::normalize(n);
-}
+// Exponential moving average of the filtered caustics over frames
+const char* causticsAccumulateFragmentShaderSource = R"(
+    #version 330 core
+    out float accumulated;
+    
+    uniform sampler2D currentMap;
+    uniform sampler2D historyMap;
+    uniform float historyWeight;
+    
+    void main() {
+        ivec2 p = ivec2(gl_FragCoord.xy);
+        accumulated = mix(texelFetch(currentMap, p, 0).r, texelFetch(historyMap, p, 0).r, historyWeight);
+    }
+)";
 
-// Function to calculate refraction direction
-glm::vec3 refract(const glm::vec3& I, const glm::vec3& N, float ior) {
-    float cosi = -glm::dot(I, N);
-    float etai = 1.0f, etat = ior;
-    glm::vec3 n = N;
-    if (cosi < 0) {
-        cosi = -cosi;
-        std::swap(etai, etat);
-        n = -N;
-    }
-    float eta = etai / etat;
-    float k = 1 - eta * eta * (1 - cosi * cosi);
-    if (k < 0) return glm::vec3(0,0,0);
-    return I * eta + n * (eta * cosi - sqrt(k));
-}
 
-// Ray tracing function (unused - kept for reference)
-glm::vec3 traceRay(const Ray& ray, int depth = 0) {
-    if (depth > 5) return glm::vec3(0,0,0);
-    float t = -ray.origin.z / ray.direction.z;
-    if (t < 0) return glm::vec3(0,0,0);
-    glm::vec3 hitPoint = ray.origin + ray.direction * t;
-    int x = static_cast<int>(hitPoint.x);
-    int y = static_cast<int>(hitPoint.y);
-    if (x < 1 || x >= width-1 || y < 1 || y >= height-1)
-        return glm::vec3(0,0,0);
-    glm::vec3 normal = getSurfaceNormal(x, y);
-    glm::vec3 refrDir = refract(ray.direction, normal, WATER_IOR);
-    if (glm::length(refrDir) < 0.001f) {
-        return glm::vec3(0,0,0);
-    }
-    Ray refrRay(hitPoint, refrDir);
-    glm::vec3 refrColor = traceRay(refrRay, depth + 1);
-    float causticIntensity = pow(1.0f - abs(glm::dot(normal, ray.direction)), 4.0f);
-    return refrColor * (1.0f - causticIntensity) + glm::vec3(1,1,1) * causticIntensity;
-}
 
-// Function to render the scene
-void renderScene() {
-    const int imageWidth = width;
-    const int imageHeight = height;
-    glm::vec3 cameraPos(0, 0, -10);
-    float fov = 60.0f;
-    float aspectRatio = float(imageWidth) / float(imageHeight);
-    for (int y = 0; y < imageHeight; ++y) {
-        for (int x = 0; x < imageWidth; ++x) {
-            float px = (2.0f * ((x + 0.5f) / imageWidth) - 1.0f) * aspectRatio * tan(fov * 0.5f * M_PI / 180.0f);
-            float py = (1.0f - 2.0f * ((y + 0.5f) / imageHeight)) * tan(fov * 0.5f * M_PI / 180.0f);
-            glm::vec3 rayDir(px, py, 1.0f);
-            Ray ray(cameraPos, rayDir);
-            glm::vec3 color = traceRay(ray);
-            cout << color.x << " " << color.y << " " << color.z << " ";
-        }
-        cout << endl;
-    }
-}
+// Global variables
+GLFWwindow* window;
+unsigned int waterVAO, waterStaticVBO, waterEBO;
+StreamBuffer waterStream; // Ring-buffered dynamic water stream
+std::vector<std::vector<unsigned char>> waterStreamTiles; // Tiles last written into each persistent region
+unsigned int bottomVAO, bottomVBO, bottomEBO;
+unsigned int skyboxVAO, skyboxVBO;
+CausticsTarget causticsTarget;
+
+// Caustics map size and storage; a size of 0 follows the window framebuffer
+int causticsMapWidth = 0;
+int causticsMapHeight = 0;
+CausticsFormat causticsFormat = CausticsFormat::R16F;
+bool causticsMipmaps = false;
+
+// Blur and temporal accumulation between the caustics and bottom passes
+CausticsFilterSettings causticsFilterSettings;
+CausticsFilter causticsFilter;
+ShaderProgram causticsBlurShaderProgram;
+ShaderProgram causticsAccumulateShaderProgram;
+ShaderProgram waterShaderProgram;
+ShaderProgram skyboxShaderProgram;
+ShaderProgram causticsShaderProgram;
+ShaderProgram bottomShaderProgram;
+ShaderProgram displacedWaterShaderProgram;
+ShaderProgram displacedCausticsShaderProgram;
+ShaderProgram gridBottomShaderProgram;
+ShaderProgram physicalCausticsShaderProgram;
+ShaderProgram physicalDisplacedCausticsShaderProgram;
+unsigned int frameUniformBuffer; // FrameUniforms, bound at FRAME_UNIFORMS_BINDING
+
+// Caustics from refraction and area ratios instead of the stylized
+// curvature pattern
+bool physicalCaustics = false;
+
+// Point light above the pool centre
+const glm::vec3 sceneLightPos(0.0f, 0.0f, 100.0f);
+
+// Bottom-plane square the caustics map covers. Physical caustics fit it to
+// the pool (poolCausticsBounds()); the stylized pattern keeps the default.
+CausticsMapBounds causticsBounds;
+ShaderProgram waveStepShaderProgram;
+
+// Which solver drives the water: the CPU solver, or the GPU-resident one
+// that keeps the height field in textures
+enum class SimulationBackend { CPU, GPU };
+SimulationBackend simulationBackend = SimulationBackend::CPU;
+GpuWaveSimulation gpuSimulation;
+
+// Displaced rendering: the water, caustics and bottom passes all draw the
+// static grid, and the only per-frame upload is one height per vertex into
+// waterHeightTexture. Always on with the GPU backend.
+bool displacedWater = false;
+unsigned int waterHeightTexture;
+std::vector<float> waterHeightScratch;
+std::vector<unsigned char> waterHeightScratchTiles;  // Tiles written into the scratch heights
+std::vector<unsigned char> waterHeightTextureTiles;  // Tiles the texture last received (empty = none yet)
+
+// Water mesh: static grid positions and indices; per-frame heights and
+// normals are written straight into waterStream
+std::vector<float> waterGridXY;
+std::vector<unsigned int> waterIndices;
+
+// Chunked water: the element buffer holds the WaterChunkMesh patterns, and
+// the water, displaced bottom and caustics passes draw only the chunks in
+// view, each at a level of detail picked from its distance to the camera
+bool chunkedWater = false;
+float waterLodDistance = 120.0f;   // Full detail up to this distance
+int causticsLod = 0;               // Fixed level for the caustics pass
+const float WATER_BOUND_Z = 10.0f; // Above the highest expected crest, for culling
+WaterChunkMesh waterChunks;
+std::vector<int> waterChunkLevels;
+std::vector<int> causticsChunkLevels;
+WaterDrawList cameraDrawList;
+WaterDrawList causticsDrawList;
 
 // Initialize OpenGL
 bool initGL() {
@@ -468,51 +682,169 @@ bool initGL() {
     return true;
 }
 
-// Generate water surface mesh
+// Generate the static part of the water mesh (positions and indices)
 void generateWaterMesh() {
-    waterVertices.clear();
-    waterIndices.clear();
-    
-    // Generate vertices
-    for (int i = 0; i < width; i++) {
-        for (int j = 0; j < height; j++) {
-            // Position (scaled to fill more of the viewport)
-            waterVertices.push_back((i - width/2.0f) * waterScale);
-            waterVertices.push_back((j - height/2.0f) * waterScale);
-            waterVertices.push_back(height_current[i][j]);
-            
-            // Compute normal using getSurfaceNormal
-            glm::vec3 normal;
-            if (i > 0 && i < width-1 && j > 0 && j < height-1) {
-                normal = getSurfaceNormal(i, j);
-            } else {
-                normal = glm::vec3(0.0f, 0.0f, 1.0f); // Default normal for edges
+    generateWaterGridXY(waterGridXY);
+    if (!chunkedWater) {
+        generateWaterIndices(waterIndices);
+        return;
+    }
+    waterChunks.build(width, height, WaterChunkMesh::kDefaultChunkQuads, waterScale, BOTTOM_Z, WATER_BOUND_Z);
+    waterIndices = waterChunks.indices();
+    std::cout << "Water mesh: " << waterChunks.chunkCount() << " chunks, " << waterChunks.levelCount()
+              << " levels of detail" << std::endl;
+}
+
+// Picks the water chunks and levels for this frame. The caustics pass keeps
+// its own fixed level; physical caustics only land near the map range on the
+// bottom, while stylized ones are drawn through the camera.
+void updateWaterDrawLists(const glm::mat4& viewProjection, const glm::vec3& eye) {
+    waterChunks.selectLevels(waterChunkLevels, viewProjection, eye, waterLodDistance);
+    waterChunks.buildDrawList(waterChunkLevels, cameraDrawList);
+
+    glm::mat4 causticsCull = viewProjection;
+    if (physicalCaustics) {
+        // Refraction moves hits by less than the water depth
+        float margin = -BOTTOM_Z;
+        float low = causticsBounds.min - margin, high = causticsBounds.min + causticsBounds.size + margin;
+        causticsCull = glm::ortho(low, high, low, high, -1000.0f, 1000.0f);
+    }
+    waterChunks.selectLevels(causticsChunkLevels, causticsCull, eye, 0.0f, causticsLod);
+    waterChunks.buildDrawList(causticsChunkLevels, causticsDrawList);
+}
+
+// Draws the water grid with the water VAO: everything, or with chunked
+// water the chunks in list
+void drawWaterGrid(const WaterDrawList& list) {
+    glBindVertexArray(waterVAO);
+    if (!chunkedWater) {
+        glDrawElements(GL_TRIANGLES, waterIndices.size(), GL_UNSIGNED_INT, 0);
+    } else if (!list.counts.empty()) {
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, list.counts.data(), GL_UNSIGNED_INT, list.offsets.data(),
+                                      static_cast<GLsizei>(list.counts.size()), list.baseVertices.data());
+    }
+}
+
+// Points the dynamic water attributes at the most recently written stream
+// region. The water VAO must be bound.
+void bindWaterSurfaceAttributes() {
+    const char* base = reinterpret_cast<const char*>(waterStream.offset());
+    glBindBuffer(GL_ARRAY_BUFFER, waterStream.buffer());
+    
+    // Normal attribute
+    glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(WaterSurfaceVertex), base + offsetof(WaterSurfaceVertex, normal));
+    glEnableVertexAttribArray(1);
+    
+    // Height attribute
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(WaterSurfaceVertex), base + offsetof(WaterSurfaceVertex, height));
+    glEnableVertexAttribArray(2);
+}
+
+// Writes the water surface for this frame into the next stream region.
+// source is a finished frame from the simulation thread with the tiles it
+// was generated from, or null to generate the surface in place from the
+// current height field. A persistent region keeps what was last written
+// into it, so only tiles active in this frame or at that write are sent;
+// the rest of the region is flat water already.
+void uploadWaterSurface(const std::vector<WaterSurfaceVertex>* source, const std::vector<unsigned char>* sourceTiles,
+                        float alpha) {
+    void* region = waterStream.beginWrite();
+    if (region) {
+        static std::vector<unsigned char> unknownTiles;
+        std::vector<unsigned char>* regionTiles = &unknownTiles;
+        if (waterStream.persistent()) {
+            waterStreamTiles.resize(waterStream.regionCount());
+            regionTiles = &waterStreamTiles[waterStream.currentRegion()];
+        } else {
+            unknownTiles.clear(); // Mapped storage is invalidated on every write
+        }
+
+        WaterSurfaceVertex* out = static_cast<WaterSurfaceVertex*>(region);
+        if (!source) {
+            generateWaterSurface(out, alpha, *regionTiles);
+        } else if (regionTiles->size() != sourceTiles->size() ||
+                   std::find(sourceTiles->begin(), sourceTiles->end(), 0) == sourceTiles->end()) {
+            std::memcpy(out, source->data(), source->size() * sizeof(WaterSurfaceVertex));
+            *regionTiles = *sourceTiles;
+        } else {
+            // One span of tiles per grid row, as for the height texture
+            const int tileRows = (width + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE;
+            const int tileCols = (height + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE;
+            for (int ti = 0; ti < tileRows; ++ti) {
+                int first = tileCols, last = -1;
+                for (int tj = 0; tj < tileCols; ++tj) {
+                    const int t = ti * tileCols + tj;
+                    if ((*sourceTiles)[t] || (*regionTiles)[t]) {
+                        first = std::min(first, tj);
+                        last = tj;
+                    }
+                }
+                if (last < 0) {
+                    continue;
+                }
+                const int col = first * ACTIVE_TILE_SIZE;
+                const int cols = std::min((last + 1) * ACTIVE_TILE_SIZE, height) - col;
+                for (int i = ti * ACTIVE_TILE_SIZE; i < std::min((ti + 1) * ACTIVE_TILE_SIZE, width); ++i) {
+                    const size_t offset = static_cast<size_t>(i) * height + col;
+                    std::memcpy(out + offset, source->data() + offset, cols * sizeof(WaterSurfaceVertex));
+                }
             }
-            
-            // Normal
-            waterVertices.push_back(normal.x);
-            waterVertices.push_back(normal.y);
-            waterVertices.push_back(normal.z);
+            *regionTiles = *sourceTiles;
         }
     }
+    waterStream.endWrite();
     
-    // Generate indices
-    for (int i = 0; i < width-1; i++) {
-        for (int j = 0; j < height-1; j++) {
-            unsigned int topLeft = i * height + j;
-            unsigned int topRight = topLeft + 1;
-            unsigned int bottomLeft = (i + 1) * height + j;
-            unsigned int bottomRight = bottomLeft + 1;
-            
-            waterIndices.push_back(topLeft);
-            waterIndices.push_back(bottomLeft);
-            waterIndices.push_back(topRight);
-            
-            waterIndices.push_back(topRight);
-            waterIndices.push_back(bottomLeft);
-            waterIndices.push_back(bottomRight);
+    glBindVertexArray(waterVAO);
+    bindWaterSurfaceAttributes();
+}
+
+// Uploads this frame's heights into waterHeightTexture. source is a finished
+// frame from the simulation thread with the tiles it was generated from, or
+// null to sample the height field here. Only tiles active in this frame or
+// the last uploaded one are sent, one rectangle per row of tiles; the rest
+// of the texture is flat water already.
+void uploadWaterHeights(const std::vector<float>* source, const std::vector<unsigned char>* sourceTiles,
+                        float alpha) {
+    if (!source) {
+        generateWaterHeights(waterHeightScratch, alpha, waterHeightScratchTiles);
+        source = &waterHeightScratch;
+        sourceTiles = &waterHeightScratchTiles;
+    }
+    glBindTexture(GL_TEXTURE_2D, waterHeightTexture);
+
+    // Tile counts only change with the grid, so this is safe to work out
+    // while the simulation thread runs
+    const int tileRows = (width + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE;
+    const int tileCols = (height + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE;
+    if (waterHeightTextureTiles.size() != sourceTiles->size() ||
+        std::find(sourceTiles->begin(), sourceTiles->end(), 0) == sourceTiles->end()) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, height, width, GL_RED, GL_FLOAT, source->data());
+        waterHeightTextureTiles = *sourceTiles;
+        return;
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, height);
+    for (int ti = 0; ti < tileRows; ++ti) {
+        int first = tileCols, last = -1;
+        for (int tj = 0; tj < tileCols; ++tj) {
+            const int t = ti * tileCols + tj;
+            if ((*sourceTiles)[t] || waterHeightTextureTiles[t]) {
+                first = std::min(first, tj);
+                last = tj;
+            }
         }
+        if (last < 0) {
+            continue;
+        }
+        const int row = ti * ACTIVE_TILE_SIZE;
+        const int rows = std::min(ACTIVE_TILE_SIZE, width - row);
+        const int col = first * ACTIVE_TILE_SIZE;
+        const int cols = std::min((last + 1) * ACTIVE_TILE_SIZE, height) - col;
+        glTexSubImage2D(GL_TEXTURE_2D, 0, col, row, cols, rows, GL_RED, GL_FLOAT,
+                        source->data() + static_cast<size_t>(row) * height + col);
     }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    waterHeightTextureTiles = *sourceTiles;
 }
 
 // Generate bottom surface mesh
@@ -558,24 +890,40 @@ void generateBottomMesh() {
 // Setup OpenGL buffers for water
 void setupWaterBuffers() {
     glGenVertexArrays(1, &waterVAO);
-    glGenBuffers(1, &waterVBO);
+    glGenBuffers(1, &waterStaticVBO);
     glGenBuffers(1, &waterEBO);
     
     glBindVertexArray(waterVAO);
     
-    glBindBuffer(GL_ARRAY_BUFFER, waterVBO);
-    glBufferData(GL_ARRAY_BUFFER, waterVertices.size() * sizeof(float), waterVertices.data(), GL_DYNAMIC_DRAW);
+    // Static stream: x/y grid positions, uploaded once
+    glBindBuffer(GL_ARRAY_BUFFER, waterStaticVBO);
+    glBufferData(GL_ARRAY_BUFFER, waterGridXY.size() * sizeof(float), waterGridXY.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
     
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, waterEBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, waterIndices.size() * sizeof(unsigned int), waterIndices.data(), GL_STATIC_DRAW);
     
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    if (displacedWater) {
+        // Heights live in a texture laid out like HeightField: texel (j, i)
+        if (simulationBackend == SimulationBackend::CPU) {
+            glGenTextures(1, &waterHeightTexture);
+            glBindTexture(GL_TEXTURE_2D, waterHeightTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, height, width, 0, GL_RED, GL_FLOAT, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            uploadWaterHeights(nullptr, nullptr, 1.0f);
+        }
+        std::cout << "Water mesh: static grid displaced in the vertex shader" << std::endl;
+        return;
+    }
     
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    // Dynamic stream: height and packed normal, streamed every frame
+    waterStream.create(static_cast<size_t>(width) * height * sizeof(WaterSurfaceVertex));
+    waterStreamTiles.clear();
+    std::cout << "Water stream: " << (waterStream.persistent() ? "persistent mapped" : "orphaning")
+              << " ring buffer" << std::endl;
+    uploadWaterSurface(nullptr, nullptr, 1.0f);
 }
 
 // Generate skybox mesh
@@ -633,57 +981,256 @@ void generateSkyboxMesh() {
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 }
 
-// Add after other function prototypes
-void setupCausticsFBO() {
-    // Create FBO
-    glGenFramebuffers(1, &causticsFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, causticsFBO);
-    
-    // Create texture
-    glGenTextures(1, &causticsTexture);
-    glBindTexture(GL_TEXTURE_2D, causticsTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+// Allocates the caustics map at its configured size, or at the window's
+// framebuffer size when none was given
+bool setupCausticsTarget() {
+    int mapWidth = causticsMapWidth, mapHeight = causticsMapHeight;
+    if (mapWidth <= 0 || mapHeight <= 0) {
+        glfwGetFramebufferSize(window, &mapWidth, &mapHeight);
+    }
+    if (!causticsTarget.create(mapWidth, mapHeight, causticsFormat, causticsMipmaps)) {
+        return false;
+    }
+    if (causticsFilterSettings.active()) {
+        return causticsFilter.create(mapWidth, mapHeight, causticsFormat, causticsFilterSettings,
+                                     causticsBlurShaderProgram.id, causticsAccumulateShaderProgram.id);
+    }
+    return true;
+}
+
+// The map the bottom pass samples: filtered when the filter is on
+unsigned int causticsMapTexture() {
+    return causticsFilterSettings.active() ? causticsFilter.output() : causticsTarget.texture();
+}
+
+// Solver tick scheduling for the interactive loop
+FixedTimestep simulationClock;
+
+// Simulation thread: steps the solver and builds water meshes off the render
+// thread, handing finished frames over through a lock-free triple buffer
+struct WaterFrame {
+    std::vector<WaterSurfaceVertex> vertices;
+    std::vector<float> heights; // Displaced rendering only
+    std::vector<unsigned char> tiles; // Active tiles the heights or vertices were generated from
+};
+
+bool asyncSimulation = true;
+TripleBuffer<WaterFrame> waterFrames;
+std::atomic<double> simulationFrameMs{0.0}; // Solver and mesh time behind the last published frame
+std::atomic<bool> simulationRunning{false};
+std::thread simulationThread;
+
+void simulationLoop() {
+    auto lastTime = std::chrono::high_resolution_clock::now();
+    double workMs = 0.0;
+
+    while (simulationRunning.load(std::memory_order_relaxed)) {
+        auto currentTime = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double>(currentTime - lastTime).count();
+        lastTime = currentTime;
+
+        int steps = simulationClock.advance(elapsed);
+        bool buildFrame = !waterFrames.hasPending();
+        if (steps > 0 || buildFrame) {
+            auto workStart = std::chrono::steady_clock::now();
+            update_wave_steps(steps);
+            // Only build a new frame once the renderer picked up the last
+            // one, so meshing runs at most at the display rate
+            if (buildFrame) {
+                WaterFrame& frame = waterFrames.writeBuffer();
+                if (displacedWater) {
+                    generateWaterHeights(frame.heights, simulationClock.alpha(), frame.tiles);
+                } else {
+                    generateWaterSurface(frame.vertices, simulationClock.alpha(), frame.tiles);
+                }
+            }
+            workMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - workStart).count();
+            if (buildFrame) {
+                simulationFrameMs.store(workMs, std::memory_order_relaxed);
+                workMs = 0.0;
+                waterFrames.publish();
+            }
+        }
+        if (!buildFrame) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+}
+
+// Rain: random drops queued from the render thread for the CPU solver
+float rainRate = 0.0f; // Drops per second (0 = off)
+
+void queueRain(double frameSeconds) {
+    static std::minstd_rand random(1);
+    static double owed = 0.0;
+    static std::vector<Disturbance> drops;
+    std::uniform_real_distribution<float> x(1.0f, width - 1.0f), y(1.0f, height - 1.0f);
+    std::uniform_real_distribution<float> radius(1.5f, 2.5f), amplitude(0.1f, 0.3f);
+
+    owed += rainRate * frameSeconds;
+    drops.resize(static_cast<size_t>(owed));
+    owed -= drops.size();
+    for (Disturbance& drop : drops) {
+        drop.x = x(random);
+        drop.y = y(random);
+        drop.radius = radius(random);
+        drop.amplitude = amplitude(random);
+    }
+    queue_disturbances(drops.data(), drops.size());
+}
+
+void startSimulationThread() {
+    simulationRunning = true;
+    simulationThread = std::thread(simulationLoop);
+}
+
+void stopSimulationThread() {
+    simulationRunning = false;
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
+}
+
+// Binds the height textures of the displaced renderer to the units the
+// samplers were pointed at by setConstantUniforms(); leaves program in use
+void useDisplacedHeights(const ShaderProgram& program) {
+    // The GPU solver interpolates between its last two levels; uploaded CPU
+    // heights are already interpolated
+    bool gpuBackend = simulationBackend == SimulationBackend::GPU;
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, gpuBackend ? gpuSimulation.currentTexture() : waterHeightTexture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, gpuBackend ? gpuSimulation.prevTexture() : waterHeightTexture);
+    glActiveTexture(GL_TEXTURE0);
     
-    // Attach texture to FBO
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, causticsTexture, 0);
+    glUseProgram(program.id);
+    glUniform1f(program.alpha, gpuBackend ? simulationClock.alpha() : 1.0f);
+}
+
+// Sets the uniforms that never change after startup: texture units and
+// physical constants. Called once per program after it is created.
+void setConstantUniforms(const ShaderProgram& program) {
+    glUseProgram(program.id);
+    glUniform1i(program.causticsTexture, 0);
+    glUniform1i(program.heightMap, 1);
+    glUniform1i(program.prevHeightMap, 2);
+    glUniform1f(program.gridSpacing, dx);
+    glUniform1f(program.bottomZ, BOTTOM_Z);
+    glUniform1f(program.waterIOR, WATER_IOR);
+    glUniform1f(program.airIOR, AIR_IOR);
+    glUniform2f(program.causticsRange, causticsBounds.min, causticsBounds.size);
+    glUniform1f(program.maxRatio, CAUSTICS_MAX_RATIO);
+    glUniform1i(program.filteredCaustics, causticsFilterSettings.active());
+}
+
+// Creates the shared per-frame uniform buffer and binds it for all programs
+void setupFrameUniforms() {
+    glGenBuffers(1, &frameUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, frameUniformBuffer);
+}
+
+// One upload per frame replaces the per-program view, projection, light,
+// camera and time uniforms
+void uploadFrameUniforms(const FrameUniforms& frame) {
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+}
+
+// Renders the caustics map for the current water surface into causticsTarget,
+// using the camera and light in the frame uniform buffer
+void renderCausticsPass() {
+    causticsTarget.begin();
     
-    // Set draw buffer once
-    GLenum buf = GL_COLOR_ATTACHMENT0;
-    glDrawBuffers(1, &buf);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE); // Additive blending for caustics accumulation
+    glDisable(GL_DEPTH_TEST);    // Disable depth test for caustics pass
     
-    // Check FBO completeness
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "FBO incomplete\n";
+    const ShaderProgram* causticsProgram;
+    if (physicalCaustics) {
+        causticsProgram = displacedWater ? &physicalDisplacedCausticsShaderProgram : &physicalCausticsShaderProgram;
+        glDisable(GL_CULL_FACE); // Folded triangles land flipped but still carry light
+    } else {
+        causticsProgram = displacedWater ? &displacedCausticsShaderProgram : &causticsShaderProgram;
+    }
+    if (displacedWater) {
+        useDisplacedHeights(*causticsProgram);
     }
     
-    // Clear the caustics texture
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    // Use the same projection as the main camera for consistency
+    glUseProgram(causticsProgram->id);
+    glm::mat4 model = glm::mat4(1.0f);
+    glUniformMatrix4fv(causticsProgram->model, 1, GL_FALSE, glm::value_ptr(model));
+    
+    drawWaterGrid(causticsDrawList);
     
-    // Reset to default framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST); // Re-enable depth test
+    causticsTarget.end();
 }
 
+// Per-pass frame timing, enabled by --profile or --profile-csv
+FrameProfiler frameProfiler;
+bool profileFrames = false;
+std::string profileTracePath;
+const double profileReportSeconds = 2.0;
+
 // Main render loop
 void renderLoop() {
-    glm::vec3 lightPos(0.0f, 0.0f, 100.0f);
+    glm::vec3 lightPos = sceneLightPos;
     glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
     
     auto startTime = std::chrono::high_resolution_clock::now();
+    auto lastFrameTime = startTime;
+    auto lastReportTime = startTime;
 
     while (!glfwWindowShouldClose(window)) {
         // Calculate time for animations
         auto currentTime = std::chrono::high_resolution_clock::now();
         float time = std::chrono::duration<float>(currentTime - startTime).count();
+        double frameSeconds = std::chrono::duration<double>(currentTime - lastFrameTime).count();
+        lastFrameTime = currentTime;
         processInput(window);
+        if (frameProfiler.enabled()) {
+            frameProfiler.beginFrame();
+        }
+        if (rainRate > 0.0f && simulationBackend == SimulationBackend::CPU) {
+            queueRain(frameSeconds);
+        }
         
-        // Update water simulation
-        update_wave();
-        generateWaterMesh();
-        glBindBuffer(GL_ARRAY_BUFFER, waterVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, waterVertices.size() * sizeof(float), waterVertices.data());
+        if (simulationBackend == SimulationBackend::GPU) {
+            // Step the height textures on the GPU; nothing is uploaded
+            ScopedPassTimer timer(frameProfiler, FramePass::Simulation);
+            gpuSimulation.step(simulationClock.advance(frameSeconds), 1 - damping, c * c * dt * dt / (dx * dx));
+        } else if (asyncSimulation) {
+            // Upload the newest mesh from the simulation thread, if any
+            if (waterFrames.acquire()) {
+                if (frameProfiler.enabled()) {
+                    frameProfiler.addCpuSample(FramePass::Simulation, simulationFrameMs.load(std::memory_order_relaxed));
+                }
+                ScopedPassTimer timer(frameProfiler, FramePass::Upload);
+                if (displacedWater) {
+                    uploadWaterHeights(&waterFrames.readBuffer().heights, &waterFrames.readBuffer().tiles, 1.0f);
+                } else {
+                    uploadWaterSurface(&waterFrames.readBuffer().vertices, &waterFrames.readBuffer().tiles, 1.0f);
+                }
+            }
+        } else {
+            // Update water simulation at a fixed rate, independent of the frame rate,
+            // and draw the surface interpolated between the last two ticks
+            {
+                ScopedPassTimer timer(frameProfiler, FramePass::Simulation);
+                update_wave_steps(simulationClock.advance(frameSeconds));
+            }
+            ScopedPassTimer timer(frameProfiler, FramePass::Upload);
+            if (displacedWater) {
+                uploadWaterHeights(nullptr, nullptr, simulationClock.alpha());
+            } else {
+                uploadWaterSurface(nullptr, nullptr, simulationClock.alpha());
+            }
+        }
         
         // Clear screen
         glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
@@ -694,97 +1241,432 @@ void renderLoop() {
         glm::mat4 view = glm::lookAt(cameraPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
         glm::mat4 projection = glm::perspective(glm::radians(60.0f), (float)SCR_WIDTH/SCR_HEIGHT, 0.1f, 300.0f);
 
+        FrameUniforms frameUniforms;
+        frameUniforms.view = view;
+        frameUniforms.projection = projection;
+        frameUniforms.lightPos = lightPos;
+        frameUniforms.time = time;
+        frameUniforms.viewPos = cameraPos;
+        uploadFrameUniforms(frameUniforms);
+        if (chunkedWater) {
+            updateWaterDrawLists(projection * view, cameraPos);
+        }
+
         // 2. Generate Caustics Texture
-        glBindFramebuffer(GL_FRAMEBUFFER, causticsFBO);
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE, GL_ONE); // Additive blending for caustics accumulation
-        glDisable(GL_DEPTH_TEST);    // Disable depth test for caustics pass
+        {
+            ScopedPassTimer timer(frameProfiler, FramePass::Caustics);
+            renderCausticsPass();
+        }
+        if (causticsFilterSettings.active()) {
+            ScopedPassTimer timer(frameProfiler, FramePass::CausticsFilter);
+            causticsFilter.apply(causticsTarget.texture());
+        }
         
-        // Use the same projection as the main camera for consistency
-        glUseProgram(causticsShaderProgram);
+        const ShaderProgram& waterProgram = displacedWater ? displacedWaterShaderProgram : waterShaderProgram;
+        const ShaderProgram& bottomProgram = displacedWater ? gridBottomShaderProgram : bottomShaderProgram;
         glm::mat4 model = glm::mat4(1.0f);
-        glUniformMatrix4fv(glGetUniformLocation(causticsShaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(glGetUniformLocation(causticsShaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(causticsShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniform3fv(glGetUniformLocation(causticsShaderProgram, "lightPos"), 1, glm::value_ptr(lightPos));
-        glUniform1f(glGetUniformLocation(causticsShaderProgram, "bottomZ"), BOTTOM_Z);
-        glUniform1f(glGetUniformLocation(causticsShaderProgram, "waterIOR"), WATER_IOR);
-        glUniform1f(glGetUniformLocation(causticsShaderProgram, "airIOR"), AIR_IOR);
-        glUniform1f(glGetUniformLocation(causticsShaderProgram, "time"), time);
-        
-        glBindVertexArray(waterVAO);
-        glDrawElements(GL_TRIANGLES, waterIndices.size(), GL_UNSIGNED_INT, 0);
-        
-        glDisable(GL_BLEND);
-        glEnable(GL_DEPTH_TEST); // Re-enable depth test
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
         // 3. Render Pool Bottom (with caustics)
-        glEnable(GL_DEPTH_TEST);
-        glUseProgram(bottomShaderProgram);
-        glm::mat4 bottomModel = glm::mat4(1.0f);
-        glUniformMatrix4fv(glGetUniformLocation(bottomShaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(bottomModel));
-        glUniformMatrix4fv(glGetUniformLocation(bottomShaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(bottomShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, causticsTexture);
-        glUniform1i(glGetUniformLocation(bottomShaderProgram, "causticsTexture"), 0);
-        glUniform1f(glGetUniformLocation(bottomShaderProgram, "time"), time);
-        
-        glBindVertexArray(bottomVAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        {
+            ScopedPassTimer timer(frameProfiler, FramePass::Bottom);
+            if (displacedWater) {
+                useDisplacedHeights(waterProgram);
+            }
+            glEnable(GL_DEPTH_TEST);
+            glUseProgram(bottomProgram.id);
+            glm::mat4 bottomModel = glm::mat4(1.0f);
+            glUniformMatrix4fv(bottomProgram.model, 1, GL_FALSE, glm::value_ptr(bottomModel));
+            
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, causticsMapTexture());
+            glUniform1f(bottomProgram.causticsBaseline, physicalCaustics ? 1.0f : 0.0f);
+            
+            if (displacedWater) {
+                drawWaterGrid(cameraDrawList);
+            } else {
+                glBindVertexArray(bottomVAO);
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            }
+        }
 
         // 4. Render Water Surface (transparent)
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        
-        glUseProgram(waterShaderProgram);
-        glUniformMatrix4fv(glGetUniformLocation(waterShaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(glGetUniformLocation(waterShaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(waterShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniform3fv(glGetUniformLocation(waterShaderProgram, "lightPos"), 1, glm::value_ptr(lightPos));
-        glUniform3fv(glGetUniformLocation(waterShaderProgram, "viewPos"), 1, glm::value_ptr(cameraPos));
-        
-        glBindVertexArray(waterVAO);
-        glDrawElements(GL_TRIANGLES, waterIndices.size(), GL_UNSIGNED_INT, 0);
-        
-        glDisable(GL_BLEND);
+        {
+            ScopedPassTimer timer(frameProfiler, FramePass::Water);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            
+            glUseProgram(waterProgram.id);
+            glUniformMatrix4fv(waterProgram.model, 1, GL_FALSE, glm::value_ptr(model));
+            
+            drawWaterGrid(cameraDrawList);
+            waterStream.fence(); // Last draw reading this frame's stream region
+            
+            glDisable(GL_BLEND);
+        }
 
         // 5. Render Skybox (background)
-        glDepthMask(GL_FALSE);
-        glUseProgram(skyboxShaderProgram);
-        glm::mat4 skyboxView = glm::mat4(glm::mat3(view));
-        glUniformMatrix4fv(glGetUniformLocation(skyboxShaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(skyboxView));
-        glUniformMatrix4fv(glGetUniformLocation(skyboxShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glBindVertexArray(skyboxVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glDepthMask(GL_TRUE);
+        {
+            ScopedPassTimer timer(frameProfiler, FramePass::Skybox);
+            glDepthMask(GL_FALSE);
+            glUseProgram(skyboxShaderProgram.id);
+            glBindVertexArray(skyboxVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glDepthMask(GL_TRUE);
+        }
+        
+        if (frameProfiler.enabled()) {
+            frameProfiler.endFrame();
+            // Rolling averages in the title bar, full percentiles on stdout
+            if (std::chrono::duration<double>(currentTime - lastReportTime).count() >= profileReportSeconds) {
+                lastReportTime = currentTime;
+                glfwSetWindowTitle(window, ("Water Caustics | " + frameProfiler.summary()).c_str());
+                if (profileFrames) {
+                    frameProfiler.printReport(std::cout);
+                    if (chunkedWater) {
+                        std::cout << "  water chunks " << cameraDrawList.chunks << "/" << waterChunks.chunkCount()
+                                  << ", " << cameraDrawList.triangles << " triangles; caustics "
+                                  << causticsDrawList.chunks << " chunks, " << causticsDrawList.triangles
+                                  << " triangles" << std::endl;
+                    }
+                }
+            }
+        }
         
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 }
 
-int main() {
+// Runs the CPU and GPU solvers side by side from the current CPU state and
+// reports how far apart they end up. Shader compilers may fuse or reorder
+// float operations, so the GPU result is compared with a tolerance relative
+// to the wave amplitude rather than bit for bit.
+int verifyGpuSimulation(int steps) {
+    GpuWaveSimulation gpu;
+    if (!gpu.create(width, height, waveStepShaderProgram.id)) {
+        return -1;
+    }
+    gpu.upload(heights);
+
+    const float keep = 1 - damping;
+    const float coeff = c * c * dt * dt / (dx * dx);
+    float maxError = 0.0f;
+    float maxAmplitude = 0.0f;
+    HeightField gpuField;
+    const int checkEvery = std::max(1, steps / 10);
+    for (int done = 0; done < steps; ) {
+        int count = std::min(checkEvery, steps - done);
+        update_wave_steps(count);
+        gpu.step(count, keep, coeff);
+        done += count;
+
+        gpu.download(gpuField);
+        const HeightField& cpuField = heights.current();
+        for (int i = 0; i < width; ++i) {
+            for (int j = 0; j < height; ++j) {
+                maxError = std::max(maxError, std::fabs(cpuField(i, j) - gpuField(i, j)));
+                maxAmplitude = std::max(maxAmplitude, std::fabs(cpuField(i, j)));
+            }
+        }
+    }
+    gpu.destroy();
+
+    const float tolerance = 1e-4f * std::max(maxAmplitude, 1.0f);
+    bool pass = maxError <= tolerance;
+    std::cout << "GPU vs CPU solver after " << steps << " steps: max abs error " << maxError
+              << " (amplitude " << maxAmplitude << ", tolerance " << tolerance << ") "
+              << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
+
+// Renders the physical caustics map on the GPU after the given number of
+// solver steps and compares it with computeCausticsMap(). Rasterization
+// rules differ along triangle edges and streamed normals are quantized, so
+// the maps are compared by total light and mean difference.
+int verifyCausticsMap(int steps) {
+    update_wave_steps(steps);
+    if (displacedWater) {
+        uploadWaterHeights(nullptr, nullptr, 1.0f);
+    } else {
+        uploadWaterSurface(nullptr, nullptr, 1.0f);
+    }
+    
+    physicalCaustics = true;
+    glm::vec3 lightPos = sceneLightPos;
+    FrameUniforms frameUniforms;
+    frameUniforms.view = frameUniforms.projection = glm::mat4(1.0f);
+    frameUniforms.lightPos = frameUniforms.viewPos = lightPos;
+    frameUniforms.time = 0.0f;
+    uploadFrameUniforms(frameUniforms);
+    if (chunkedWater) {
+        updateWaterDrawLists(frameUniforms.projection * frameUniforms.view, lightPos);
+    }
+    renderCausticsPass();
+    
+    std::vector<float> gpuMap;
+    causticsTarget.download(gpuMap);
+    
+    std::vector<float> cpuMap;
+    computeCausticsMap(cpuMap, causticsTarget.width(), causticsTarget.height(), causticsBounds, lightPos);
+    
+    double gpuTotal = 0.0, cpuTotal = 0.0, difference = 0.0;
+    for (size_t i = 0; i < cpuMap.size(); ++i) {
+        float gpuValue = gpuMap[i];
+        gpuTotal += gpuValue;
+        cpuTotal += cpuMap[i];
+        difference += std::fabs(gpuValue - cpuMap[i]);
+    }
+    double totalError = std::fabs(gpuTotal - cpuTotal) / std::max(cpuTotal, 1.0);
+    double meanError = difference / std::max(cpuTotal, 1.0);
+    bool pass = totalError < 0.01 && meanError < 0.05;
+    std::cout << "Caustics after " << steps << " steps: total light GPU " << gpuTotal << ", CPU " << cpuTotal
+              << ", relative difference " << totalError << ", mean abs difference " << meanError
+              << " of total " << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --headless           Run the simulation without a window and write height fields\n"
+              << "  --size N | WxH       Simulation grid size (default 200x200)\n"
+              << "  --steps N            Headless: number of time steps (default 1000)\n"
+              << "  --output-every N     Headless: write a frame every N steps (default: final only)\n"
+              << "  --output-dir DIR     Headless: directory for output files (default .)\n"
+              << "  --photons N          Headless: also write photon-traced caustics maps with N photons\n"
+              << "  --caustics-size N    Headless: caustics map resolution (default 512)\n"
+              << "  --render FILE        Headless: ray trace the final state to FILE (.pfm or .ppm)\n"
+              << "  --render-size WxH    Headless: render resolution (default: grid size)\n"
+              << "  --render-lanes N     Headless: rays per SIMD packet, 1/4/8/16 (default: widest)\n"
+              << "  --render-plane       Headless: trace against the z = 0 plane (packet tracer)\n"
+              << "  --threads N          Solver threads (default: one per hardware thread)\n"
+              << "  --block-steps N      Time steps per temporally blocked pass (1 = off)\n"
+              << "  --sparse EPS         Only step tiles with heights above EPS, plus a halo (0 = off)\n"
+              << "  --sim-rate HZ        Interactive: solver ticks per second (default 60)\n"
+              << "  --max-substeps N     Interactive: most solver ticks per frame (default 4)\n"
+              << "  --sync-sim           Interactive: run the solver on the render thread\n"
+              << "  --rain N             Interactive: drop N rain drops per second on the CPU solver\n"
+              << "  --gpu-sim            Interactive: run the solver on the GPU in float textures\n"
+              << "  --displace           Interactive: upload heights only and displace a static grid\n"
+              << "  --physical-caustics  Interactive: caustics from refraction and area ratios\n"
+              << "  --caustics-res WxH   Interactive: caustics map resolution (default: window size)\n"
+              << "  --caustics-format F  Interactive: caustics map storage, r16f or r32f (default r16f)\n"
+              << "  --caustics-mips      Interactive: mipmap the caustics map for the bottom's taps\n"
+              << "  --caustics-blur R    Interactive: Gaussian blur of radius R (max 16) on the caustics map\n"
+              << "  --caustics-blur-scale N\n"
+              << "                       Interactive: filter at 1/N of the caustics map size (default 2)\n"
+              << "  --caustics-temporal W\n"
+              << "                       Interactive: keep W (0-0.99) of the previous caustics each frame\n"
+              << "  --water-lod D        Interactive: chunked water with frustum culling, halving detail\n"
+              << "                       each time the distance doubles past D (0 = full detail)\n"
+              << "  --caustics-lod N     Interactive: level of detail of the caustics pass (implies chunks)\n"
+              << "  --profile            Interactive: report per-pass CPU/GPU frame timings every 2 s\n"
+              << "  --profile-csv FILE   Interactive: write per-pass timings of every frame to FILE\n"
+              << "  --verify-caustics    Run --steps steps and compare GPU and CPU physical caustics\n"
+              << "  --verify-gpu-sim     Run --steps steps on the CPU and GPU solvers and compare\n"
+              << "  --help               Show this message" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    bool headless = false;
+    bool verifyGpu = false;
+    bool verifyCaustics = false;
+    HeadlessOptions headlessOptions;
+    int gridWidth = width;
+    int gridHeight = height;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--size" && hasValue) {
+            const char* value = argv[++i];
+            if (std::sscanf(value, "%dx%d", &gridWidth, &gridHeight) != 2) {
+                gridHeight = gridWidth = std::atoi(value);
+            }
+        } else if (arg == "--steps" && hasValue) {
+            headlessOptions.steps = std::atoi(argv[++i]);
+        } else if (arg == "--output-every" && hasValue) {
+            headlessOptions.outputEvery = std::atoi(argv[++i]);
+        } else if (arg == "--output-dir" && hasValue) {
+            headlessOptions.outputDir = argv[++i];
+        } else if (arg == "--photons" && hasValue) {
+            headlessOptions.photons = std::atoll(argv[++i]);
+        } else if (arg == "--caustics-size" && hasValue) {
+            headlessOptions.causticsSize = std::atoi(argv[++i]);
+        } else if (arg == "--render" && hasValue) {
+            headlessOptions.renderPath = argv[++i];
+        } else if (arg == "--render-size" && hasValue) {
+            const char* value = argv[++i];
+            if (std::sscanf(value, "%dx%d", &headlessOptions.renderWidth, &headlessOptions.renderHeight) != 2) {
+                headlessOptions.renderHeight = headlessOptions.renderWidth = std::atoi(value);
+            }
+        } else if (arg == "--render-plane") {
+            headlessOptions.renderPlane = true;
+        } else if (arg == "--render-lanes" && hasValue) {
+            headlessOptions.renderLanes = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            solverThreads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--block-steps" && hasValue) {
+            temporalBlockSteps = std::atoi(argv[++i]);
+        } else if (arg == "--sparse" && hasValue) {
+            sparseEpsilon = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--sim-rate" && hasValue) {
+            simulationClock.rate = std::atof(argv[++i]);
+        } else if (arg == "--max-substeps" && hasValue) {
+            simulationClock.maxSubsteps = std::atoi(argv[++i]);
+        } else if (arg == "--gpu-sim") {
+            simulationBackend = SimulationBackend::GPU;
+        } else if (arg == "--physical-caustics") {
+            physicalCaustics = true;
+        } else if (arg == "--caustics-res" && hasValue) {
+            const char* value = argv[++i];
+            if (std::sscanf(value, "%dx%d", &causticsMapWidth, &causticsMapHeight) != 2) {
+                causticsMapHeight = causticsMapWidth = std::atoi(value);
+            }
+            if (causticsMapWidth < 1 || causticsMapHeight < 1) {
+                std::cerr << "--caustics-res must be positive" << std::endl;
+                return -1;
+            }
+        } else if (arg == "--caustics-format" && hasValue) {
+            std::string format = argv[++i];
+            if (format == "r16f") {
+                causticsFormat = CausticsFormat::R16F;
+            } else if (format == "r32f") {
+                causticsFormat = CausticsFormat::R32F;
+            } else {
+                std::cerr << "--caustics-format must be r16f or r32f" << std::endl;
+                return -1;
+            }
+        } else if (arg == "--caustics-mips") {
+            causticsMipmaps = true;
+        } else if (arg == "--caustics-blur" && hasValue) {
+            causticsFilterSettings.blurRadius = std::atoi(argv[++i]);
+        } else if (arg == "--caustics-blur-scale" && hasValue) {
+            causticsFilterSettings.downscale = std::atoi(argv[++i]);
+        } else if (arg == "--caustics-temporal" && hasValue) {
+            causticsFilterSettings.historyWeight = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--water-lod" && hasValue) {
+            waterLodDistance = static_cast<float>(std::atof(argv[++i]));
+            chunkedWater = true;
+        } else if (arg == "--caustics-lod" && hasValue) {
+            causticsLod = std::atoi(argv[++i]);
+            chunkedWater = true;
+        } else if (arg == "--profile") {
+            profileFrames = true;
+        } else if (arg == "--profile-csv" && hasValue) {
+            profileTracePath = argv[++i];
+        } else if (arg == "--verify-caustics") {
+            verifyCaustics = true;
+        } else if (arg == "--displace") {
+            displacedWater = true;
+        } else if (arg == "--verify-gpu-sim") {
+            verifyGpu = true;
+        } else if (arg == "--rain" && hasValue) {
+            rainRate = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--sync-sim") {
+            asyncSimulation = false;
+        } else if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (simulationClock.rate <= 0.0 || simulationClock.maxSubsteps < 1) {
+        std::cerr << "--sim-rate and --max-substeps must be positive" << std::endl;
+        return -1;
+    }
+    if (causticsFilterSettings.blurRadius < 0 || causticsFilterSettings.blurRadius > CausticsFilter::kMaxBlurRadius ||
+        causticsFilterSettings.downscale < 1 || causticsFilterSettings.historyWeight < 0.0f ||
+        causticsFilterSettings.historyWeight > 0.99f) {
+        std::cerr << "--caustics-blur must be 0-16, --caustics-blur-scale at least 1 and --caustics-temporal 0-0.99"
+                  << std::endl;
+        return -1;
+    }
+    if (waterLodDistance < 0.0f || causticsLod < 0) {
+        std::cerr << "--water-lod and --caustics-lod must not be negative" << std::endl;
+        return -1;
+    }
+    if (sparseEpsilon < 0.0f || rainRate < 0.0f) {
+        std::cerr << "--sparse and --rain must not be negative" << std::endl;
+        return -1;
+    }
+    if (headlessOptions.causticsSize < 1) {
+        std::cerr << "--caustics-size must be positive" << std::endl;
+        return -1;
+    }
+    if (gridWidth < 3 || gridHeight < 3) {
+        std::cerr << "Grid size must be at least 3x3" << std::endl;
+        return -1;
+    }
+    if (gridWidth != width || gridHeight != height) {
+        resize_grid(gridWidth, gridHeight);
+    }
+
+    std::cout << "Wave solver kernel: " << simdIsaName(waveKernelIsa)
+              << ", " << solverPool().size() << " thread(s)";
+    if (sparseEpsilon > 0.0f) {
+        std::cout << ", sparse " << ACTIVE_TILE_SIZE << "x" << ACTIVE_TILE_SIZE << " tiles above " << sparseEpsilon;
+    }
+    std::cout << std::endl;
+
+    if (headless) {
+        return runHeadless(headlessOptions);
+    }
+
     if (!initGL()) {
         return -1;
     }
     
+    if (physicalCaustics || verifyCaustics) {
+        causticsBounds = poolCausticsBounds(sceneLightPos);
+    }
+
     // Create and compile shaders
     waterShaderProgram = createShaderProgram(waterVertexShaderSource, waterFragmentShaderSource);
     skyboxShaderProgram = createShaderProgram(skyboxVertexShaderSource, skyboxFragmentShaderSource);
     causticsShaderProgram = createShaderProgram(causticsVertexShaderSource, causticsFragmentShaderSource);
     bottomShaderProgram = createShaderProgram(bottomVertexShaderSource, bottomFragmentShaderSource);
+    std::string displacedWaterSource = std::string(heightTextureSurfaceShaderSource) + displacedWaterVertexShaderSource;
+    std::string physicalCausticsSource = std::string(streamedSurfaceShaderSource) + physicalCausticsVertexShaderSource;
+    std::string physicalDisplacedCausticsSource = std::string(heightTextureSurfaceShaderSource) + physicalCausticsVertexShaderSource;
+    displacedWaterShaderProgram = createShaderProgram(displacedWaterSource.c_str(), waterFragmentShaderSource);
+    displacedCausticsShaderProgram = createShaderProgram(displacedWaterSource.c_str(), causticsFragmentShaderSource);
+    physicalCausticsShaderProgram = createShaderProgram(physicalCausticsSource.c_str(), physicalCausticsFragmentShaderSource);
+    physicalDisplacedCausticsShaderProgram = createShaderProgram(physicalDisplacedCausticsSource.c_str(), physicalCausticsFragmentShaderSource);
+    gridBottomShaderProgram = createShaderProgram(gridBottomVertexShaderSource, bottomFragmentShaderSource);
+    waveStepShaderProgram = createShaderProgram(fullscreenVertexShaderSource, waveStepFragmentShaderSource);
+    causticsBlurShaderProgram = createShaderProgram(fullscreenVertexShaderSource, causticsBlurFragmentShaderSource);
+    causticsAccumulateShaderProgram = createShaderProgram(fullscreenVertexShaderSource, causticsAccumulateFragmentShaderSource);
+    for (const ShaderProgram* program : {&waterShaderProgram, &skyboxShaderProgram, &causticsShaderProgram,
+                                         &bottomShaderProgram, &displacedWaterShaderProgram,
+                                         &displacedCausticsShaderProgram, &gridBottomShaderProgram,
+                                         &physicalCausticsShaderProgram, &physicalDisplacedCausticsShaderProgram}) {
+        setConstantUniforms(*program);
+    }
+    setupFrameUniforms();
     
     // Initialize water simulation
     init_grid();
-    add_disturbance(50, 50, 2.0f);
-    add_disturbance(150, 150, 1.5f);
-    add_disturbance(75, 125, 1.8f);
+    add_initial_disturbances();
+    
+    if (verifyGpu) {
+        int result = verifyGpuSimulation(headlessOptions.steps);
+        glfwTerminate();
+        return result;
+    }
+    if (simulationBackend == SimulationBackend::GPU) {
+        if (!gpuSimulation.create(width, height, waveStepShaderProgram.id)) {
+            return -1;
+        }
+        gpuSimulation.upload(heights);
+        asyncSimulation = false; // Nothing left for a simulation thread to do
+        displacedWater = true;   // Heights never leave the GPU
+    }
     
     // Generate and setup meshes
     generateWaterMesh();
@@ -797,25 +1679,68 @@ int main() {
     glEnable(GL_CULL_FACE); // Enable face culling for performance
     glCullFace(GL_BACK); // Cull back faces
 
-    // Setup caustics FBO
-    setupCausticsFBO();
+    // Setup the caustics render target
+    if (!setupCausticsTarget()) {
+        glfwTerminate();
+        return -1;
+    }
+    
+    if (verifyCaustics) {
+        int result = verifyCausticsMap(headlessOptions.steps);
+        glfwTerminate();
+        return result;
+    }
+    
+    if (profileFrames || !profileTracePath.empty()) {
+        frameProfiler.create(true);
+        if (!profileTracePath.empty() && !frameProfiler.openTrace(profileTracePath)) {
+            // Release the queries while the context still exists
+            frameProfiler.destroy();
+            glfwTerminate();
+            return -1;
+        }
+    }
     
     // Start render loop
+    if (asyncSimulation) {
+        startSimulationThread();
+    }
     renderLoop();
+    stopSimulationThread();
+    if (frameProfiler.enabled()) {
+        frameProfiler.printReport(std::cout);
+        frameProfiler.destroy();
+    }
     
     // Cleanup
     glDeleteVertexArrays(1, &waterVAO);
-    glDeleteBuffers(1, &waterVBO);
+    waterStream.destroy();
+    glDeleteBuffers(1, &waterStaticVBO);
     glDeleteBuffers(1, &waterEBO);
     glDeleteVertexArrays(1, &bottomVAO);
     glDeleteBuffers(1, &bottomVBO);
     glDeleteBuffers(1, &bottomEBO);
     glDeleteVertexArrays(1, &skyboxVAO);
     glDeleteBuffers(1, &skyboxVBO);
-    glDeleteProgram(waterShaderProgram);
-    glDeleteProgram(skyboxShaderProgram);
-    glDeleteProgram(causticsShaderProgram);
-    glDeleteProgram(bottomShaderProgram);
+    glDeleteProgram(waterShaderProgram.id);
+    glDeleteProgram(skyboxShaderProgram.id);
+    glDeleteProgram(causticsShaderProgram.id);
+    glDeleteProgram(bottomShaderProgram.id);
+    glDeleteProgram(displacedWaterShaderProgram.id);
+    glDeleteProgram(displacedCausticsShaderProgram.id);
+    glDeleteProgram(gridBottomShaderProgram.id);
+    glDeleteProgram(physicalCausticsShaderProgram.id);
+    glDeleteProgram(physicalDisplacedCausticsShaderProgram.id);
+    glDeleteProgram(waveStepShaderProgram.id);
+    glDeleteProgram(causticsBlurShaderProgram.id);
+    glDeleteProgram(causticsAccumulateShaderProgram.id);
+    glDeleteBuffers(1, &frameUniformBuffer);
+    causticsTarget.destroy();
+    causticsFilter.destroy();
+    if (displacedWater && simulationBackend == SimulationBackend::CPU) {
+        glDeleteTextures(1, &waterHeightTexture);
+    }
+    gpuSimulation.destroy();
     
     glfwTerminate();
     return 0;
@@ -824,6 +1749,14 @@ int main() {
 // Callback function for window resize
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    // A map that follows the window is reallocated; minimized windows report 0
+    bool followsWindow = causticsMapWidth <= 0 || causticsMapHeight <= 0;
+    if (followsWindow && width > 0 && height > 0 && causticsTarget.texture()) {
+        causticsTarget.resize(width, height);
+        if (causticsFilterSettings.active()) {
+            causticsFilter.resize(width, height);
+        }
+    }
 }
 
 // Process input
@@ -832,6 +1765,10 @@ void processInput(GLFWwindow* window) {
         glfwSetWindowShouldClose(window, true);
 }
 
+// Splash queued for the CPU solver by a left click
+const float CLICK_SPLASH_RADIUS = 3.0f;     // Grid cells
+const float CLICK_SPLASH_AMPLITUDE = 1.0f;
+
 // Mouse click callback for disturbances
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
@@ -848,13 +1785,22 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 
         // Ensure coordinates are within bounds and add disturbance
         if (gridX >= 0 && gridX < width && gridY >= 0 && gridY < height) {
-            add_disturbance(gridX, gridY, 5.0f); // Add a disturbance with a height of 5.0
+            if (simulationBackend == SimulationBackend::GPU) {
+                gpuSimulation.addDisturbance(gridX, gridY, 5.0f);
+                return;
+            }
+            Disturbance splash;
+            splash.x = static_cast<float>(gridX);
+            splash.y = static_cast<float>(gridY);
+            splash.radius = CLICK_SPLASH_RADIUS;
+            splash.amplitude = CLICK_SPLASH_AMPLITUDE;
+            queue_disturbance(splash);
         }
     }
 }
 
-// Create and compile shader program
-unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+// Create and compile shader program, and resolve its uniform locations
+ShaderProgram createShaderProgram(const char* vertexSource, const char* fragmentSource) {
     unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertexShader, 1, &vertexSource, NULL);
     glCompileShader(vertexShader);
@@ -891,5 +1837,27 @@ unsigned int createShaderProgram(const char* vertexSource, const char* fragmentS
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
     
-    return shaderProgram;
+    ShaderProgram program;
+    program.id = shaderProgram;
+    program.model = glGetUniformLocation(shaderProgram, "model");
+    program.alpha = glGetUniformLocation(shaderProgram, "alpha");
+    program.gridSpacing = glGetUniformLocation(shaderProgram, "gridSpacing");
+    program.heightMap = glGetUniformLocation(shaderProgram, "heightMap");
+    program.prevHeightMap = glGetUniformLocation(shaderProgram, "prevHeightMap");
+    program.causticsTexture = glGetUniformLocation(shaderProgram, "causticsTexture");
+    program.causticsBaseline = glGetUniformLocation(shaderProgram, "causticsBaseline");
+    program.filteredCaustics = glGetUniformLocation(shaderProgram, "filteredCaustics");
+    program.bottomZ = glGetUniformLocation(shaderProgram, "bottomZ");
+    program.waterIOR = glGetUniformLocation(shaderProgram, "waterIOR");
+    program.airIOR = glGetUniformLocation(shaderProgram, "airIOR");
+    program.causticsRange = glGetUniformLocation(shaderProgram, "causticsRange");
+    program.maxRatio = glGetUniformLocation(shaderProgram, "maxRatio");
+    
+    // Programs that declare the frame block read it from the shared buffer
+    unsigned int frameBlock = glGetUniformBlockIndex(shaderProgram, "FrameUniforms");
+    if (frameBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(shaderProgram, frameBlock, FRAME_UNIFORMS_BINDING);
+    }
+    
+    return program;
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Lock-free bounded multi-producer / single-consumer ring. Any thread may
+// push(); one consumer thread pop()s. Every slot carries a sequence number
+// saying whether it is free for a given position or holds that position's
+// value, so producers only contend on the tail counter and never wait for
+// each other or for the consumer. A full ring rejects what does not fit
+// instead of blocking.
+template <typename T>
+class MpscQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit MpscQueue(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        slots.reset(new Slot[size]);
+        for (std::size_t i = 0; i < size; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Producer side, any thread. Claims consecutive positions with one
+    // compare-and-swap and returns how many of the values fit.
+    std::size_t push(const T* values, std::size_t count) {
+        std::size_t pos, claimed;
+        for (;;) {
+            // Head first: it never passes the tail read after it
+            const std::size_t consumed = head.load(std::memory_order_acquire);
+            pos = tail.load(std::memory_order_relaxed);
+            claimed = std::min(count, mask + 1 - std::min(pos - consumed, mask + 1));
+            if (claimed == 0) {
+                return 0;
+            }
+            // The consumer frees slots in order, so if the last claimed slot
+            // is free all of them are
+            const Slot& last = slots[(pos + claimed - 1) & mask];
+            if (last.sequence.load(std::memory_order_acquire) != pos + claimed - 1) {
+                continue;
+            }
+            if (tail.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (std::size_t k = 0; k < claimed; ++k) {
+            Slot& slot = slots[(pos + k) & mask];
+            slot.value = values[k];
+            slot.sequence.store(pos + k + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    bool push(const T& value) { return push(&value, 1) == 1; }
+
+    // Consumer side, one thread only. Returns false when the ring is empty or
+    // the next value is still being written; it shows up on a later call.
+    bool pop(T& value) {
+        const std::size_t pos = head.load(std::memory_order_relaxed);
+        Slot& slot = slots[pos & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        value = slot.value;
+        slot.sequence.store(pos + mask + 1, std::memory_order_release);
+        head.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask = 0;
+    alignas(64) std::atomic<std::size_t> tail{0};  // Next position to claim
+    alignas(64) std::atomic<std::size_t> head{0};  // Next position to pop
+};
@@ -0,0 +1,141 @@
+#include "photon_caustics.h"
+#include "caustics_map.h"
+#include "ray_tracing.h"
+#include "simulation.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+// Grid rows claimed per chunk; small enough for the tail to balance well
+static const int photonChunkRows = 4;
+
+// splitmix64, one independent stream per chunk so results do not depend on
+// which thread traced which chunk
+static inline std::uint64_t nextRandom(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline float randomUnit(std::uint64_t& state) {
+    return (nextRandom(state) >> 40) * (1.0f / 16777216.0f); // 24 bits in [0, 1)
+}
+
+PhotonCausticsStats tracePhotonCaustics(const PhotonCausticsOptions& options, std::vector<float>& map) {
+    auto start = std::chrono::steady_clock::now();
+    PhotonCausticsStats stats;
+
+    const int mapWidth = options.mapWidth;
+    const int mapHeight = options.mapHeight;
+    const size_t mapSize = static_cast<size_t>(mapWidth) * mapHeight;
+    map.assign(mapSize, 0.0f);
+
+    const long long cells = static_cast<long long>(width - 1) * (height - 1);
+    const int photonsPerCell = static_cast<int>(std::max(1LL, (options.photons + cells - 1) / cells));
+    stats.photons = cells * photonsPerCell;
+
+    const CausticsMapBounds& bounds = options.bounds;
+    const glm::vec2 toPixels(mapWidth / bounds.size, mapHeight / bounds.size);
+    const glm::vec3 up(0.0f, 0.0f, 1.0f);
+    ThreadPool& pool = solverPool();
+
+    // Per-vertex heights, normals and flat-water landing points, shared by
+    // the four cells around each vertex
+    std::vector<float> vertexHeights(static_cast<size_t>(width) * height);
+    std::vector<glm::vec3> vertexNormals(vertexHeights.size());
+    std::vector<glm::vec2> restPoints(vertexHeights.size());
+    pool.parallelFor(width, [&](int i) {
+        for (int j = 0; j < height; j++) {
+            size_t index = static_cast<size_t>(i) * height + j;
+            glm::vec3 rest((i - width/2.0f) * waterScale, (j - height/2.0f) * waterScale, 0.0f);
+            vertexHeights[index] = heights.current()(i, j);
+            vertexNormals[index] = (i > 0 && i < width-1 && j > 0 && j < height-1) ? getSurfaceNormal(i, j) : up;
+            restPoints[index] = (glm::vec2(projectToBottom(options.lightPos, rest, up)) - bounds.min) * toPixels;
+        }
+    });
+
+    // One accumulation map per pool slot; each slot loops claiming chunks
+    const int slots = static_cast<int>(pool.size());
+    std::vector<std::vector<float>> slotMaps(slots);
+    std::vector<long long> slotLanded(slots, 0);
+    const int chunkCount = (width - 1 + photonChunkRows - 1) / photonChunkRows;
+    std::atomic<int> nextChunk{0};
+
+    pool.parallelFor(slots, [&](int slot) {
+        std::vector<float>& local = slotMaps[slot];
+        local.assign(mapSize, 0.0f);
+        long long landed = 0;
+
+        for (int chunk = nextChunk.fetch_add(1); chunk < chunkCount; chunk = nextChunk.fetch_add(1)) {
+            std::uint64_t rng = options.seed * 0x2545F4914F6CDD1Dull + static_cast<std::uint64_t>(chunk);
+            int rowEnd = std::min(width - 1, (chunk + 1) * photonChunkRows);
+
+            for (int i = chunk * photonChunkRows; i < rowEnd; i++) {
+                for (int j = 0; j < height - 1; j++) {
+                    size_t v00 = static_cast<size_t>(i) * height + j;
+                    size_t v01 = v00 + 1;
+                    size_t v10 = v00 + height;
+                    size_t v11 = v10 + 1;
+
+                    // Footprint of this cell on the bottom under flat water,
+                    // shared out between its photons
+                    const glm::vec2& r00 = restPoints[v00];
+                    const glm::vec2& r11 = restPoints[v11];
+                    glm::vec2 d1 = r11 - r00;
+                    glm::vec2 d2 = restPoints[v10] - restPoints[v01];
+                    float restArea = 0.5f * std::fabs(d1.x * d2.y - d1.y * d2.x);
+                    float weight = restArea / photonsPerCell;
+
+                    for (int p = 0; p < photonsPerCell; p++) {
+                        float u = randomUnit(rng);
+                        float v = randomUnit(rng);
+
+                        // Bilinear surface point and normal inside the cell
+                        float h = (1 - u) * ((1 - v) * vertexHeights[v00] + v * vertexHeights[v01]) +
+                                  u * ((1 - v) * vertexHeights[v10] + v * vertexHeights[v11]);
+                        glm::vec3 n = (1 - u) * ((1 - v) * vertexNormals[v00] + v * vertexNormals[v01]) +
+                                      u * ((1 - v) * vertexNormals[v10] + v * vertexNormals[v11]);
+                        glm::vec3 surface((i + u - width/2.0f) * waterScale, (j + v - height/2.0f) * waterScale, h);
+
+                        glm::vec3 incident = glm::normalize(surface - options.lightPos);
+                        glm::vec3 refracted = refract(incident, glm::normalize(n), WATER_IOR);
+                        if (refracted.z >= 0.0f) {
+                            continue;
+                        }
+                        glm::vec3 hit = surface + refracted * ((BOTTOM_Z - surface.z) / refracted.z);
+
+                        float px = (hit.x - bounds.min) * toPixels.x;
+                        float py = (hit.y - bounds.min) * toPixels.y;
+                        if (px >= 0.0f && py >= 0.0f && px < mapWidth && py < mapHeight) {
+                            local[static_cast<size_t>(py) * mapWidth + static_cast<size_t>(px)] += weight;
+                            landed++;
+                        }
+                    }
+                }
+            }
+        }
+        slotLanded[slot] = landed;
+    });
+
+    // Reduce the slot maps, one band of map rows per task
+    pool.parallelFor(mapHeight, [&](int row) {
+        float* out = map.data() + static_cast<size_t>(row) * mapWidth;
+        for (const std::vector<float>& local : slotMaps) {
+            if (local.empty()) {
+                continue;
+            }
+            const float* in = local.data() + static_cast<size_t>(row) * mapWidth;
+            for (int x = 0; x < mapWidth; x++) {
+                out[x] += in[x];
+            }
+        }
+    });
+    for (long long landed : slotLanded) {
+        stats.landed += landed;
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
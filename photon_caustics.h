@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "caustics_map.h"
+
+// Offline caustics by photon splatting. Photons leave a point light, hit
+// the water surface at jittered positions, are refracted with refract()
+// and binned where they land on the pool bottom. The map covers bounds on
+// the bottom plane (see caustics_map.h; poolCausticsBounds() fits the whole
+// pool) and uses the same scale as the GPU caustics pass: every grid cell's
+// photons together carry the light that cell would put on the bottom under
+// flat water, so undisturbed water gives 1.
+struct PhotonCausticsOptions {
+    long long photons = 10000000;          // Total photons, spread evenly over grid cells
+    int mapWidth = 512;
+    int mapHeight = 512;
+    CausticsMapBounds bounds;              // Bottom-plane square the map covers
+    glm::vec3 lightPos{0.0f, 0.0f, 100.0f};
+    std::uint64_t seed = 1;                // Same seed and grid give the same photons
+};
+
+struct PhotonCausticsStats {
+    long long photons = 0;   // Photons actually traced
+    long long landed = 0;    // Photons that landed inside the map
+    double seconds = 0.0;    // Wall time for tracing and reduction
+    double photonsPerSecond() const { return seconds > 0.0 ? photons / seconds : 0.0; }
+};
+
+// Traces the current height field into map (mapWidth x mapHeight, row 0 at
+// bounds.min in y). Runs on solverPool(): workers claim chunks of grid
+// rows as they become free, splat into their own map, and the maps are
+// summed at the end, so no two threads ever write the same buffer.
+PhotonCausticsStats tracePhotonCaustics(const PhotonCausticsOptions& options, std::vector<float>& map);
@@ -0,0 +1,98 @@
+#include "ray_packet.h"
+#include "ray_tracing.h"
+#include "simulation.h"
+
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CAUSTICS_PACKET_SIMD 1
+#include <immintrin.h>
+#endif
+
+#ifdef CAUSTICS_PACKET_SIMD
+
+// Each block below compiles ray_packet_kernel.inl for one instruction set.
+// Only this file's own kernel code sits inside the target regions; every
+// header is included above, so no shared inline function is ever built
+// with an instruction set the CPU might lack.
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+namespace packet_sse {
+#define PACKET_LANES 4
+#define PACKET_SQRT(v) _mm_sqrt_ps((__m128)(v))
+#include "ray_packet_kernel.inl"
+#undef PACKET_SQRT
+#undef PACKET_LANES
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace packet_avx2 {
+#define PACKET_LANES 8
+#define PACKET_SQRT(v) _mm256_sqrt_ps((__m256)(v))
+#include "ray_packet_kernel.inl"
+#undef PACKET_SQRT
+#undef PACKET_LANES
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+namespace packet_avx512 {
+#define PACKET_LANES 16
+// Zero-masked form: same result, avoids a GCC false positive on _mm512_undefined_ps
+#define PACKET_SQRT(v) _mm512_maskz_sqrt_ps(0xFFFF, (__m512)(v))
+#include "ray_packet_kernel.inl"
+#undef PACKET_SQRT
+#undef PACKET_LANES
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif // CAUSTICS_PACKET_SIMD
+
+int packetLaneCount(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::SSE: return 4;
+        case SimdIsa::AVX2: return 8;
+        case SimdIsa::AVX512: return 16;
+        default: return 1;
+    }
+}
+
+PacketTraceKernel getPacketTraceKernel(SimdIsa isa) {
+#ifdef CAUSTICS_PACKET_SIMD
+    switch (isa) {
+        case SimdIsa::SSE: return packet_sse::tracePacket;
+        case SimdIsa::AVX2: return packet_avx2::tracePacket;
+        case SimdIsa::AVX512: return packet_avx512::tracePacket;
+        default: break;
+    }
+#endif
+    return nullptr;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "wave_kernels.h"
+
+// Packet ray tracing: the same light transport as traceRay(), run for
+// several rays at once in structure-of-arrays SIMD lanes. Lanes that miss
+// the water or stop refracting are masked off while the rest continue.
+
+const int kMaxPacketLanes = 16;
+
+struct RayPacket {
+    float originX[kMaxPacketLanes];
+    float originY[kMaxPacketLanes];
+    float originZ[kMaxPacketLanes];
+    float directionX[kMaxPacketLanes];  // Unit length
+    float directionY[kMaxPacketLanes];
+    float directionZ[kMaxPacketLanes];
+    int count = 0;                      // Rays in use, at most the kernel's lane count
+};
+
+// Traces every ray in the packet and writes its white-light intensity
+// (the value traceRay() returns in each channel) to light[0..count)
+typedef void (*PacketTraceKernel)(const RayPacket& packet, float* light);
+
+// Rays per packet for an instruction set: 4 (SSE), 8 (AVX2), 16 (AVX-512),
+// or 1 for scalar, which has no packet kernel
+int packetLaneCount(SimdIsa isa);
+
+// Packet kernel for the given ISA, or null for scalar or when it is not
+// compiled in
+PacketTraceKernel getPacketTraceKernel(SimdIsa isa);
@@ -0,0 +1,117 @@
+// Packet trace kernel body. ray_packet.cpp includes this file once per
+// instruction set, inside a namespace, with PACKET_LANES and PACKET_SQRT
+// defined and the matching target pragma in effect, so the generic vector
+// code below compiles to that ISA. Do not include it anywhere else.
+
+typedef float Floats __attribute__((vector_size(PACKET_LANES * 4)));
+typedef int Ints __attribute__((vector_size(PACKET_LANES * 4)));
+
+static inline Floats load(const float* p) {
+    Floats v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline Floats splat(float value) {
+    return Floats{} + value;
+}
+
+static inline Floats select(Ints mask, Floats a, Floats b) {
+    return (Floats)(((Ints)a & mask) | ((Ints)b & ~mask));
+}
+
+static inline Floats squareRoot(Floats v) {
+    return (Floats)PACKET_SQRT(v);
+}
+
+static inline bool anyLane(Ints mask) {
+    for (int l = 0; l < PACKET_LANES; ++l) {
+        if (mask[l]) return true;
+    }
+    return false;
+}
+
+static void tracePacket(const RayPacket& packet, float* lightOut) {
+    Floats ox = load(packet.originX), oy = load(packet.originY), oz = load(packet.originZ);
+    Floats dirX = load(packet.directionX), dirY = load(packet.directionY), dirZ = load(packet.directionZ);
+
+    Ints active;
+    for (int l = 0; l < PACKET_LANES; ++l) {
+        active[l] = l < packet.count ? -1 : 0;
+    }
+
+    const HeightField& field = heights.current();
+    const Floats one = splat(1.0f);
+    const Floats zero = splat(0.0f);
+    const Floats gradientScale = splat(2.0f * dx);
+    const float eta = 1.0f / WATER_IOR;   // Entering the water
+    const float etaInv = WATER_IOR;       // Leaving it
+    Floats light = zero;
+    Floats throughput = one;
+
+    for (int depth = 0; depth <= maxRayDepth; ++depth) {
+        // Intersect the z = 0 plane
+        Floats t = -oz / dirZ;
+        active &= ~(t < zero);
+        Floats hx = ox + dirX * t;
+        Floats hy = oy + dirY * t;
+        Floats hz = oz + dirZ * t;
+        Ints ix = __builtin_convertvector(hx, Ints);
+        Ints iy = __builtin_convertvector(hy, Ints);
+        active &= (ix >= 1) & (ix < width - 1) & (iy >= 1) & (iy < height - 1);
+        if (!anyLane(active)) break;
+
+        // Gather the central differences of getSurfaceNormal(); masked
+        // lanes read a safe interior cell
+        Floats right, left, up, down;
+        for (int l = 0; l < PACKET_LANES; ++l) {
+            int x = active[l] ? ix[l] : 1;
+            int y = active[l] ? iy[l] : 1;
+            right[l] = field(x + 1, y);
+            left[l] = field(x - 1, y);
+            up[l] = field(x, y + 1);
+            down[l] = field(x, y - 1);
+        }
+        Floats nx = -((right - left) / gradientScale);
+        Floats ny = -((up - down) / gradientScale);
+        Floats inverseLength = one / squareRoot(nx * nx + ny * ny + one);
+        nx *= inverseLength;
+        ny *= inverseLength;
+        Floats nz = inverseLength;
+
+        // refract(): flip the normal and the index ratio for rays leaving
+        Floats cosi = -(dirX * nx + dirY * ny + dirZ * nz);
+        Ints leaving = cosi < zero;
+        cosi = select(leaving, -cosi, cosi);
+        Floats etaLanes = select(leaving, splat(etaInv), splat(eta));
+        Floats sx = select(leaving, -nx, nx);
+        Floats sy = select(leaving, -ny, ny);
+        Floats sz = select(leaving, -nz, nz);
+        Floats k = one - etaLanes * etaLanes * (one - cosi * cosi);
+        Ints refracts = ~(k < zero);
+        Floats bend = etaLanes * cosi - squareRoot(select(refracts, k, zero));
+        Floats rx = select(refracts, dirX * etaLanes + sx * bend, zero);
+        Floats ry = select(refracts, dirY * etaLanes + sy * bend, zero);
+        Floats rz = select(refracts, dirZ * etaLanes + sz * bend, zero);
+        Floats refractedLength = squareRoot(rx * rx + ry * ry + rz * rz);
+        active &= ~(refractedLength < splat(0.001f));
+        if (!anyLane(active)) break;
+
+        // Caustic light at this hit, then carry on along the refracted ray
+        Floats facing = dirX * nx + dirY * ny + dirZ * nz;
+        Floats p = one - select(facing < zero, -facing, facing);
+        Floats intensity = p * p * (p * p);
+        light += select(active, throughput * intensity, zero);
+        throughput = select(active, throughput * (one - intensity), throughput);
+
+        Floats inverseRefracted = one / select(active, refractedLength, one);
+        ox = hx; oy = hy; oz = hz;
+        dirX = select(active, rx * inverseRefracted, dirX);
+        dirY = select(active, ry * inverseRefracted, dirY);
+        dirZ = select(active, rz * inverseRefracted, one);
+    }
+
+    for (int l = 0; l < packet.count; ++l) {
+        lightOut[l] = light[l];
+    }
+}
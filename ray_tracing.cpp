@@ -0,0 +1,175 @@
+#include "ray_tracing.h"
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include "height_mip.h"
+#include "image_io.h"
+#include "ray_packet.h"
+
+// Function to calculate refraction direction
+glm::vec3 refract(const glm::vec3& I, const glm::vec3& N, float ior) {
+    float cosi = -glm::dot(I, N);
+    float etai = 1.0f, etat = ior;
+    glm::vec3 n = N;
+    if (cosi < 0) {
+        cosi = -cosi;
+        std::swap(etai, etat);
+        n = -N;
+    }
+    float eta = etai / etat;
+    float k = 1 - eta * eta * (1 - cosi * cosi);
+    if (k < 0) return glm::vec3(0,0,0);
+    return I * eta + n * (eta * cosi - std::sqrt(k));
+}
+
+// Follows the ray through up to maxRayDepth refractions at the water
+// surface. Each hit adds white light weighted by causticIntensity and passes
+// the rest on to the refracted ray, which is what the original recursion
+// computed from the innermost call outwards.
+glm::vec3 traceRay(const Ray& primary) {
+    glm::vec3 color(0, 0, 0);
+    float throughput = 1.0f;
+    Ray ray = primary;
+    for (int depth = 0; depth <= maxRayDepth; ++depth) {
+        float t = -ray.origin.z / ray.direction.z;
+        if (t < 0) break;
+        glm::vec3 hitPoint = ray.origin + ray.direction * t;
+        int x = static_cast<int>(hitPoint.x);
+        int y = static_cast<int>(hitPoint.y);
+        if (x < 1 || x >= width-1 || y < 1 || y >= height-1)
+            break;
+        glm::vec3 normal = getSurfaceNormal(x, y);
+        glm::vec3 refrDir = refract(ray.direction, normal, WATER_IOR);
+        if (glm::length(refrDir) < 0.001f) {
+            break;
+        }
+        float causticIntensity = std::pow(1.0f - std::fabs(glm::dot(normal, ray.direction)), 4.0f);
+        color += glm::vec3(1,1,1) * (throughput * causticIntensity);
+        throughput *= 1.0f - causticIntensity;
+        ray = Ray(hitPoint, refrDir);
+    }
+    return color;
+}
+
+// Smallest distance along a ray before it may hit the surface again, so a
+// refracted ray does not re-hit the point it left from
+static const float surfaceEpsilon = 1e-3f;
+
+glm::vec3 traceRayHeightField(const Ray& primary, const HeightMinMaxMip& mip) {
+    glm::vec3 color(0, 0, 0);
+    float throughput = 1.0f;
+    Ray ray = primary;
+    for (int depth = 0; depth <= maxRayDepth; ++depth) {
+        float t;
+        glm::vec3 normal;
+        if (!intersectHeightField(mip, ray.origin, ray.direction, surfaceEpsilon,
+                                  std::numeric_limits<float>::max(), t, normal)) {
+            break;
+        }
+        glm::vec3 hitPoint = ray.origin + ray.direction * t;
+        glm::vec3 refrDir = refract(ray.direction, normal, WATER_IOR);
+        if (glm::length(refrDir) < 0.001f) {
+            break;
+        }
+        float causticIntensity = std::pow(1.0f - std::fabs(glm::dot(normal, ray.direction)), 4.0f);
+        color += glm::vec3(1,1,1) * (throughput * causticIntensity);
+        throughput *= 1.0f - causticIntensity;
+        ray = Ray(hitPoint, refrDir);
+    }
+    return color;
+}
+
+void Framebuffer::resize(int newWidth, int newHeight) {
+    imageWidth = newWidth;
+    imageHeight = newHeight;
+    pixels.assign(static_cast<size_t>(imageWidth) * imageHeight * 3, 0.0f);
+}
+
+// Renders the scene into framebuffer, which must already be sized. Tiles
+// are handed out to the solver pool; each pixel is written exactly once,
+// so no synchronization is needed.
+void renderScene(Framebuffer& framebuffer, const RenderSettings& settings) {
+    const int imageWidth = framebuffer.imageWidth;
+    const int imageHeight = framebuffer.imageHeight;
+    const int tileSize = std::max(1, settings.tileSize);
+    const int tilesX = (imageWidth + tileSize - 1) / tileSize;
+    const int tilesY = (imageHeight + tileSize - 1) / tileSize;
+
+    // Camera basis: the direction through pixel (x, y) is
+    // topLeft + (x + 0.5) * stepRight - (y + 0.5) * stepUp
+    const float tanHalfFov = std::tan(settings.fov * 0.5f * float(M_PI) / 180.0f);
+    const float aspectRatio = float(imageWidth) / float(imageHeight);
+    const glm::vec3 stepRight = settings.cameraRight * (2.0f * aspectRatio * tanHalfFov / imageWidth);
+    const glm::vec3 stepUp = settings.cameraUp * (2.0f * tanHalfFov / imageHeight);
+    const glm::vec3 topLeft = settings.cameraForward
+        - settings.cameraRight * (aspectRatio * tanHalfFov)
+        + settings.cameraUp * tanHalfFov;
+
+    // Primary rays share an origin and their directions step evenly along
+    // a row, so a row segment fills a packet directly
+    PacketTraceKernel packetKernel = settings.marchHeightField ? nullptr : getPacketTraceKernel(settings.packetIsa);
+    const int lanes = packetLaneCount(settings.packetIsa);
+
+    // Update the pyramid for whatever the solver changed since the last render
+    HeightMinMaxMip& mip = surfaceMip();
+    if (settings.marchHeightField) {
+        mip.refresh();
+    }
+
+    solverPool().parallelFor(tilesX * tilesY, [&](int tile) {
+        int x0 = (tile % tilesX) * tileSize;
+        int y0 = (tile / tilesX) * tileSize;
+        int x1 = std::min(x0 + tileSize, imageWidth);
+        int y1 = std::min(y0 + tileSize, imageHeight);
+        RayPacket packet;
+        float light[kMaxPacketLanes];
+        for (int y = y0; y < y1; ++y) {
+            float* out = framebuffer.pixels.data() + (static_cast<size_t>(y) * imageWidth + x0) * 3;
+            glm::vec3 rowStart = topLeft - stepUp * (y + 0.5f);
+            if (!packetKernel) {
+                for (int x = x0; x < x1; ++x, out += 3) {
+                    Ray ray(settings.cameraPos, rowStart + stepRight * (x + 0.5f));
+                    glm::vec3 color = settings.marchHeightField ? traceRayHeightField(ray, mip) : traceRay(ray);
+                    out[0] = color.x;
+                    out[1] = color.y;
+                    out[2] = color.z;
+                }
+                continue;
+            }
+            for (int x = x0; x < x1; x += lanes) {
+                packet.count = std::min(lanes, x1 - x);
+                for (int l = 0; l < packet.count; ++l) {
+                    glm::vec3 direction = glm::normalize(rowStart + stepRight * (x + l + 0.5f));
+                    packet.originX[l] = settings.cameraPos.x;
+                    packet.originY[l] = settings.cameraPos.y;
+                    packet.originZ[l] = settings.cameraPos.z;
+                    packet.directionX[l] = direction.x;
+                    packet.directionY[l] = direction.y;
+                    packet.directionZ[l] = direction.z;
+                }
+                for (int l = packet.count; l < lanes; ++l) {
+                    // Unused lanes are masked off but must still hold finite values
+                    packet.originX[l] = packet.originY[l] = packet.originZ[l] = 0.0f;
+                    packet.directionX[l] = packet.directionY[l] = 0.0f;
+                    packet.directionZ[l] = 1.0f;
+                }
+                packetKernel(packet, light);
+                for (int l = 0; l < packet.count; ++l, out += 3) {
+                    out[0] = out[1] = out[2] = light[l];
+                }
+            }
+        }
+    });
+}
+
+bool writeFramebuffer(const std::string& path, const Framebuffer& framebuffer) {
+    const int stride = framebuffer.imageWidth * 3;
+    std::string extension = std::filesystem::path(path).extension().string();
+    if (extension == ".ppm") {
+        return writePPM(path, framebuffer.pixels.data(), framebuffer.imageWidth, framebuffer.imageHeight, stride);
+    }
+    return writePFM(path, framebuffer.pixels.data(), framebuffer.imageWidth, framebuffer.imageHeight, stride, 3);
+}
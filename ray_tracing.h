@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "wave_kernels.h"
+
+// CPU ray tracing through the water surface. GL-free, so it is available
+// to headless batch tools as well as the interactive app.
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    Ray(const glm::vec3& o, const glm::vec3& d) : origin(o), direction(glm::normalize(d)) {}
+};
+
+// Function to calculate refraction direction
+glm::vec3 refract(const glm::vec3& I, const glm::vec3& N, float ior);
+
+// Most refractions followed per primary ray
+const int maxRayDepth = 5;
+
+// Traces one ray through the water surface and returns its light. The
+// surface is approximated by the plane z = 0 with the normal of the grid
+// cell below the hit.
+glm::vec3 traceRay(const Ray& ray);
+
+class HeightMinMaxMip;
+
+// Same light transport, but rays are intersected with the displaced height
+// field itself using the min/max pyramid, so grazing rays refract where they
+// actually meet the waves. mip must be current (see HeightMinMaxMip::refresh).
+glm::vec3 traceRayHeightField(const Ray& ray, const HeightMinMaxMip& mip);
+
+// Offline render target: RGB floats, top row first, allocated once
+struct Framebuffer {
+    int imageWidth = 0;
+    int imageHeight = 0;
+    std::vector<float> pixels;
+
+    void resize(int newWidth, int newHeight);
+};
+
+// Pinhole camera for renderScene(); the basis vectors must be orthonormal
+struct RenderSettings {
+    glm::vec3 cameraPos{0.0f, 0.0f, -10.0f};
+    glm::vec3 cameraForward{0.0f, 0.0f, 1.0f};
+    glm::vec3 cameraRight{1.0f, 0.0f, 0.0f};
+    glm::vec3 cameraUp{0.0f, 1.0f, 0.0f};
+    float fov = 60.0f;    // Vertical field of view in degrees
+    int tileSize = 32;    // Pixels per side of a parallel work item
+    SimdIsa packetIsa = detectSimdIsa(); // Packet width (see ray_packet.h); Scalar traces one ray at a time
+    bool marchHeightField = true;        // Intersect the real surface; false uses the z = 0 plane and packets
+};
+
+void renderScene(Framebuffer& framebuffer, const RenderSettings& settings);
+
+// Writes the framebuffer as PPM (8-bit, clamped) if path ends in .ppm and
+// as RGB PFM otherwise
+bool writeFramebuffer(const std::string& path, const Framebuffer& framebuffer);
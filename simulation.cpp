@@ -0,0 +1,491 @@
+#include <algorithm>
+#include <limits>
+#include "simulation.h"
+#include "mpsc_queue.h"
+
+// Water simulation parameters
+int width = 200;
+int height = 200;
+float dx = 1.0f;        // Grid spacing
+float dt = 0.7f;        // Time step
+float c = 1.0f;         // Wave speed
+float damping = 0.01f;  // Damping factor
+float waterScale = 2.0f; // Scale factor for water surface size
+unsigned solverThreads = 0; // Wave solver threads (0 = one per hardware thread)
+int solverBandRows = 32;    // Grid rows per solver work item
+int temporalBlockSteps = 4; // Time steps per memory pass in update_wave_steps (1 = off)
+int temporalBlockRows = 64; // Output rows per temporally blocked band
+float sparseEpsilon = 0.0f; // Heights below this count as calm water (0 = step every cell)
+
+// Water height grids for simulation (row i = x, column j = y)
+HeightFieldRing heights(width, height);
+
+// Heights written since the last takeChangedRegion()
+static GridRegion changedRegion;
+
+static void markChanged(int rowBegin, int rowEnd, int colBegin, int colEnd){
+    if (changedRegion.empty()){
+        changedRegion = {rowBegin, rowEnd, colBegin, colEnd};
+        return;
+    }
+    changedRegion.rowBegin = std::min(changedRegion.rowBegin, rowBegin);
+    changedRegion.rowEnd = std::max(changedRegion.rowEnd, rowEnd);
+    changedRegion.colBegin = std::min(changedRegion.colBegin, colBegin);
+    changedRegion.colEnd = std::max(changedRegion.colEnd, colEnd);
+}
+
+GridRegion takeChangedRegion(){
+    GridRegion region = changedRegion;
+    changedRegion = GridRegion();
+    return region;
+}
+
+// Sparse stepping state. tileEnergetic and tileMax are only kept up to date
+// while sparseEpsilon > 0.
+static ActiveTiles tiles;
+static std::vector<unsigned char> tileEnergetic; // Above the epsilon in current or prev
+static std::vector<float> tileMax;               // Max |height| of the current level
+static std::vector<float> tileNextMax;           // Same for next, filled while stepping
+
+// Marks every tile energetic, for after writes that bypass the tracking
+static void wakeAllTiles(){
+    tiles.rows = (width + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE;
+    tiles.cols = (height + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE;
+    const size_t count = static_cast<size_t>(tiles.rows) * tiles.cols;
+    tiles.active.assign(count, 1);
+    tileEnergetic.assign(count, 1);
+    tileMax.assign(count, std::numeric_limits<float>::infinity());
+    tileNextMax.assign(count, 0.0f);
+}
+
+const ActiveTiles& activeTiles(){
+    if (tiles.rows != (width + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE ||
+        tiles.cols != (height + ACTIVE_TILE_SIZE - 1) / ACTIVE_TILE_SIZE){
+        wakeAllTiles();
+    }
+    return tiles;
+}
+
+// Active tiles are the energetic ones grown by one tile in every direction
+static void dilateEnergeticTiles(){
+    for (int ti = 0; ti < tiles.rows; ++ti){
+        for (int tj = 0; tj < tiles.cols; ++tj){
+            unsigned char any = 0;
+            for (int a = std::max(ti - 1, 0); a <= std::min(ti + 1, tiles.rows - 1) && !any; ++a){
+                for (int b = std::max(tj - 1, 0); b <= std::min(tj + 1, tiles.cols - 1); ++b){
+                    any |= tileEnergetic[a * tiles.cols + b];
+                }
+            }
+            tiles.active[ti * tiles.cols + tj] = any;
+        }
+    }
+}
+
+// Marks the tiles covering cells as energetic and wakes their halo; peak
+// bounds how much any height there grew by. Even a change below the epsilon
+// counts for a step, so no cell is left nonzero outside the active set.
+static void wakeTiles(const GridRegion& cells, float peak){
+    if (sparseEpsilon <= 0.0f || cells.empty()) return;
+    activeTiles();
+    const int rowBegin = cells.rowBegin / ACTIVE_TILE_SIZE;
+    const int rowEnd = (cells.rowEnd - 1) / ACTIVE_TILE_SIZE + 1;
+    const int colBegin = cells.colBegin / ACTIVE_TILE_SIZE;
+    const int colEnd = (cells.colEnd - 1) / ACTIVE_TILE_SIZE + 1;
+    for (int ti = rowBegin; ti < rowEnd; ++ti){
+        for (int tj = colBegin; tj < colEnd; ++tj){
+            tileEnergetic[ti * tiles.cols + tj] = 1;
+            tileMax[ti * tiles.cols + tj] += peak;
+        }
+    }
+    for (int ti = std::max(rowBegin - 1, 0); ti < std::min(rowEnd + 1, tiles.rows); ++ti){
+        for (int tj = std::max(colBegin - 1, 0); tj < std::min(colEnd + 1, tiles.cols); ++tj){
+            tiles.active[ti * tiles.cols + tj] = 1;
+        }
+    }
+}
+
+// Stencil kernel for the widest SIMD instruction set this CPU supports
+const SimdIsa waveKernelIsa = detectSimdIsa();
+const WaveRowKernel waveRowKernel = getWaveRowKernel(waveKernelIsa);
+const RowPeakKernel rowPeakKernel = getRowPeakKernel(waveKernelIsa);
+const StampRowKernel stampRowKernel = getStampRowKernel(waveKernelIsa);
+
+// Worker pool shared by the solver, created on first use
+ThreadPool& solverPool() {
+    static ThreadPool pool(solverThreads);
+    return pool;
+}
+
+// Disturbances queued by input and other threads, created on first use
+static MpscQueue<Disturbance>& disturbanceQueue(){
+    static MpscQueue<Disturbance> queue(16384);
+    return queue;
+}
+
+std::size_t queue_disturbances(const Disturbance* events, std::size_t count){
+    return disturbanceQueue().push(events, count);
+}
+
+bool queue_disturbance(const Disturbance& event){
+    return disturbanceQueue().push(event);
+}
+
+void apply_queued_disturbances(){
+    static std::vector<Disturbance> pending;
+    pending.clear();
+    Disturbance event;
+    while (disturbanceQueue().pop(event)){
+        pending.push_back(event);
+    }
+    stamp_disturbances(pending.data(), pending.size());
+}
+
+void stamp_disturbances(const Disturbance* events, std::size_t count){
+    // Cells each stamp covers, clipped to the interior since edges stay at zero
+    static std::vector<GridRegion> bounds;
+    bounds.resize(count);
+    GridRegion touched;
+    touched.rowBegin = width;
+    touched.colBegin = height;
+    for (std::size_t k = 0; k < count; ++k){
+        const Disturbance& event = events[k];
+        const float radius = std::max(event.radius, 0.5f);
+        GridRegion& cells = bounds[k];
+        cells.rowBegin = std::max(static_cast<int>(std::ceil(event.x - radius)), 1);
+        cells.rowEnd = std::min(static_cast<int>(std::floor(event.x + radius)) + 1, width - 1);
+        cells.colBegin = std::max(static_cast<int>(std::ceil(event.y - radius)), 1);
+        cells.colEnd = std::min(static_cast<int>(std::floor(event.y + radius)) + 1, height - 1);
+        if (cells.empty()) continue;
+        touched.rowBegin = std::min(touched.rowBegin, cells.rowBegin);
+        touched.rowEnd = std::max(touched.rowEnd, cells.rowEnd);
+        touched.colBegin = std::min(touched.colBegin, cells.colBegin);
+        touched.colEnd = std::max(touched.colEnd, cells.colEnd);
+    }
+    if (touched.empty()) return;
+
+    // Bands of rows in parallel. Each band applies the stamps overlapping it
+    // in order, so overlapping stamps add up the same for any thread count.
+    HeightField& field = heights.current();
+    const int bandCount = (touched.rowEnd - touched.rowBegin + solverBandRows - 1) / solverBandRows;
+    solverPool().parallelFor(bandCount, [&](int band){
+        const int first = touched.rowBegin + band * solverBandRows;
+        const int last = std::min(first + solverBandRows, touched.rowEnd);
+        for (std::size_t k = 0; k < count; ++k){
+            const Disturbance& event = events[k];
+            const GridRegion& cells = bounds[k];
+            if (cells.empty() || cells.rowEnd <= first || cells.rowBegin >= last) continue;
+            const float radius = std::max(event.radius, 0.5f);
+            for (int i = std::max(cells.rowBegin, first); i < std::min(cells.rowEnd, last); ++i){
+                stampRowKernel(field.row(i), cells.colBegin, cells.colEnd, event.y,
+                               (i - event.x) * (i - event.x), 1.0f / (radius * radius), event.amplitude);
+            }
+        }
+    });
+
+    markChanged(touched.rowBegin, touched.rowEnd, touched.colBegin, touched.colEnd);
+    for (std::size_t k = 0; k < count; ++k){
+        wakeTiles(bounds[k], std::abs(events[k].amplitude));
+    }
+}
+
+// One step over the active tiles only; see ActiveTiles
+static void update_wave_sparse(){
+    activeTiles();
+    const HeightField& height_current = heights.current();
+    const HeightField& height_prev = heights.prev();
+    HeightField& height_next = heights.next();
+
+    const float keep = 1 - damping;
+    const float coeff = c * c * dt * dt / (dx * dx);
+
+    // Tile rows with anything to step are the work items. Runs of adjacent
+    // active tiles are stepped as one span per grid row, edges included.
+    static std::vector<int> tileRows;
+    tileRows.clear();
+    for (int ti = 0; ti < tiles.rows; ++ti){
+        if (std::find(tiles.active.begin() + ti * tiles.cols, tiles.active.begin() + (ti + 1) * tiles.cols, 1) !=
+            tiles.active.begin() + (ti + 1) * tiles.cols){
+            tileRows.push_back(ti);
+        }
+    }
+    solverPool().parallelFor(static_cast<int>(tileRows.size()), [&](int item){
+        const int ti = tileRows[item];
+        const int first = ti * ACTIVE_TILE_SIZE;
+        const int last = std::min(first + ACTIVE_TILE_SIZE, width);
+        for (int runBegin = 0; runBegin < tiles.cols;){
+            if (!tiles.at(ti, runBegin)){
+                ++runBegin;
+                continue;
+            }
+            int runEnd = runBegin + 1;
+            while (runEnd < tiles.cols && tiles.at(ti, runEnd)){
+                ++runEnd;
+            }
+            const int colBegin = runBegin * ACTIVE_TILE_SIZE;
+            const int colEnd = std::min(runEnd * ACTIVE_TILE_SIZE, height);
+
+            float* peaks = &tileNextMax[ti * tiles.cols];
+            std::fill(peaks + runBegin, peaks + runEnd, 0.0f);
+            for (int i = first; i < last; ++i){
+                float* out = height_next.row(i);
+                if (i == 0 || i == width - 1){
+                    std::fill(out + colBegin, out + colEnd, 0.0f);
+                    continue;
+                }
+                waveRowKernel(height_current.row(i - 1), height_current.row(i), height_current.row(i + 1),
+                              height_prev.row(i), out, std::max(colBegin, 1), std::min(colEnd, height - 1),
+                              keep, coeff);
+                if (colBegin == 0) out[0] = 0.0f;
+                if (colEnd == height) out[height - 1] = 0.0f;
+
+                // Tile peaks while the row is still in cache
+                for (int tj = runBegin; tj < runEnd; ++tj){
+                    peaks[tj] = std::max(peaks[tj], rowPeakKernel(out, tj * ACTIVE_TILE_SIZE,
+                                                                  std::min((tj + 1) * ACTIVE_TILE_SIZE, height)));
+                }
+            }
+            runBegin = runEnd;
+        }
+    });
+
+    // A stepped tile stays energetic while either of the two levels it keeps
+    // (the old current, now prev, and the new current) is above the epsilon
+    GridRegion stepped;
+    stepped.rowBegin = tiles.rows;
+    stepped.colBegin = tiles.cols;
+    for (int t = 0; t < static_cast<int>(tiles.active.size()); ++t){
+        if (!tiles.active[t]) continue;
+        tileEnergetic[t] = std::max(tileNextMax[t], tileMax[t]) > sparseEpsilon;
+        tileMax[t] = tileNextMax[t];
+        stepped.rowBegin = std::min(stepped.rowBegin, t / tiles.cols);
+        stepped.rowEnd = std::max(stepped.rowEnd, t / tiles.cols + 1);
+        stepped.colBegin = std::min(stepped.colBegin, t % tiles.cols);
+        stepped.colEnd = std::max(stepped.colEnd, t % tiles.cols + 1);
+    }
+    heights.advance();
+
+    // Stepped tiles left outside the new active set are flattened in every
+    // level, next included since it is recycled as the level after current
+    static std::vector<unsigned char> wasActive;
+    wasActive = tiles.active;
+    dilateEnergeticTiles();
+    for (int t = 0; t < static_cast<int>(tiles.active.size()); ++t){
+        if (!wasActive[t] || tiles.active[t]) continue;
+        const int first = (t / tiles.cols) * ACTIVE_TILE_SIZE;
+        const int last = std::min(first + ACTIVE_TILE_SIZE, width);
+        const int colBegin = (t % tiles.cols) * ACTIVE_TILE_SIZE;
+        const int colEnd = std::min(colBegin + ACTIVE_TILE_SIZE, height);
+        for (HeightField* field : {&heights.prev(), &heights.current(), &heights.next()}){
+            for (int i = first; i < last; ++i){
+                std::fill(field->row(i) + colBegin, field->row(i) + colEnd, 0.0f);
+            }
+        }
+        tileMax[t] = 0.0f;
+    }
+
+    if (!stepped.empty()){
+        markChanged(stepped.rowBegin * ACTIVE_TILE_SIZE, std::min(stepped.rowEnd * ACTIVE_TILE_SIZE, width),
+                    stepped.colBegin * ACTIVE_TILE_SIZE, std::min(stepped.colEnd * ACTIVE_TILE_SIZE, height));
+    }
+}
+
+// fluid simulation logic
+void update_wave(){
+    apply_queued_disturbances();
+    if (sparseEpsilon > 0.0f){
+        update_wave_sparse();
+        return;
+    }
+
+    const HeightField& height_current = heights.current();
+    const HeightField& height_prev = heights.prev();
+    HeightField& height_next = heights.next();
+
+    // Wave equation coefficients are constant across the grid
+    const float keep = 1 - damping;
+    const float coeff = c * c * dt * dt / (dx * dx);
+
+    // Split the interior rows into bands and step them in parallel. Each
+    // cell only reads the previous time levels, so bands are independent
+    // and the result does not depend on the thread count.
+    const int interiorRows = width - 2;
+    const int bandCount = (interiorRows + solverBandRows - 1) / solverBandRows;
+    solverPool().parallelFor(bandCount, [&](int band){
+        int first = 1 + band * solverBandRows;
+        int last = std::min(first + solverBandRows, width - 1);
+        for (int i = first; i < last; ++i){
+            waveRowKernel(height_current.row(i - 1), height_current.row(i), height_current.row(i + 1),
+                          height_prev.row(i), height_next.row(i), 1, height - 1, keep, coeff);
+        }
+    });
+
+    // Edges are held at zero. The buffer rotated in as next still holds the
+    // field from two steps ago, so its border has to be cleared explicitly.
+    std::fill(height_next.row(0), height_next.row(0) + height, 0.0f);
+    std::fill(height_next.row(width - 1), height_next.row(width - 1) + height, 0.0f);
+    for (int i = 1; i < width - 1; ++i){
+        height_next(i, 0) = 0.0f;
+        height_next(i, height - 1) = 0.0f;
+    }
+
+    // Rotate buffers
+    heights.advance();
+    markChanged(0, width, 0, height);
+}
+
+// Spare grid that receives the previous time level from update_wave_blocked
+HeightField blockedPrev;
+
+// Advances one band of rows through several time steps in a private scratch
+// ring. The band is loaded with a halo of one row per step on each side; the
+// valid region shrinks by a row per step (except at the fixed grid edges),
+// leaving exactly rows [first, last) valid at the end.
+void step_band_blocked(int first, int last, int steps, float keep, float coeff){
+    thread_local HeightFieldRing scratch;
+
+    const int lo = std::max(0, first - steps);
+    const int hi = std::min(width, last + steps);
+    if (scratch.current().rows() < hi - lo || scratch.current().cols() != height){
+        scratch.resize(temporalBlockRows + 2 * steps, height);
+    }
+
+    const HeightField& height_current = heights.current();
+    const HeightField& height_prev = heights.prev();
+    for (int i = lo; i < hi; ++i){
+        std::copy(height_current.row(i), height_current.row(i) + height, scratch.current().row(i - lo));
+        std::copy(height_prev.row(i), height_prev.row(i) + height, scratch.prev().row(i - lo));
+    }
+
+    for (int s = 1; s <= steps; ++s){
+        const HeightField& cur = scratch.current();
+        const HeightField& prv = scratch.prev();
+        HeightField& nxt = scratch.next();
+
+        const int validLo = (lo == 0) ? 0 : lo + s;
+        const int validHi = (hi == width) ? width : hi - s;
+        for (int i = std::max(validLo, 1); i < std::min(validHi, width - 1); ++i){
+            const int r = i - lo;
+            waveRowKernel(cur.row(r - 1), cur.row(r), cur.row(r + 1),
+                          prv.row(r), nxt.row(r), 1, height - 1, keep, coeff);
+            nxt(r, 0) = 0.0f;
+            nxt(r, height - 1) = 0.0f;
+        }
+        if (validLo == 0){
+            std::fill(nxt.row(0), nxt.row(0) + height, 0.0f);
+        }
+        if (validHi == width){
+            std::fill(nxt.row(width - 1 - lo), nxt.row(width - 1 - lo) + height, 0.0f);
+        }
+        scratch.advance();
+    }
+
+    HeightField& out_current = heights.next();
+    for (int i = first; i < last; ++i){
+        std::copy(scratch.current().row(i - lo), scratch.current().row(i - lo) + height, out_current.row(i));
+        std::copy(scratch.prev().row(i - lo), scratch.prev().row(i - lo) + height, blockedPrev.row(i));
+    }
+}
+
+// Temporally blocked solver: advances the grid by several time steps while
+// each band is resident in cache, instead of streaming the whole grid
+// through memory once per step. Results match the same number of
+// update_wave() calls bit for bit.
+void update_wave_blocked(int steps){
+    if (steps <= 0) return;
+    apply_queued_disturbances();
+
+    if (blockedPrev.rows() != width || blockedPrev.cols() != height){
+        blockedPrev.resize(width, height);
+    }
+
+    const float keep = 1 - damping;
+    const float coeff = c * c * dt * dt / (dx * dx);
+
+    // Bands cover every row including the fixed edges, so the whole of
+    // next and blockedPrev is written
+    const int bandCount = (width + temporalBlockRows - 1) / temporalBlockRows;
+    solverPool().parallelFor(bandCount, [&](int band){
+        int first = band * temporalBlockRows;
+        int last = std::min(first + temporalBlockRows, width);
+        step_band_blocked(first, last, steps, keep, coeff);
+    });
+
+    // next holds step N and blockedPrev step N - 1. Swap blockedPrev into
+    // the current slot so that advance() makes it prev, next current, and
+    // recycles the old prev; the old current becomes the new spare.
+    std::swap(heights.current(), blockedPrev);
+    heights.advance();
+    markChanged(0, width, 0, height);
+    if (sparseEpsilon > 0.0f){
+        wakeAllTiles();
+    }
+}
+
+// Advances the simulation by a number of steps, using the temporally
+// blocked solver when it is enabled and sparse stepping is not. Only full
+// blocks of temporalBlockSteps go through it: a shorter block copies each
+// band in and out for too few steps to save memory traffic, so the
+// remainder (and a single tick) is stepped with update_wave().
+void update_wave_steps(int steps){
+    if (temporalBlockSteps > 1 && sparseEpsilon <= 0.0f){
+        while (steps >= temporalBlockSteps){
+            update_wave_blocked(temporalBlockSteps);
+            steps -= temporalBlockSteps;
+        }
+    }
+    for (int s = 0; s < steps; ++s){
+        update_wave();
+    }
+}
+
+void add_disturbance(int x, int y, float height){
+    heights.current()(x, y) = height;
+    markChanged(x, x + 1, y, y + 1);
+
+    wakeTiles({x, x + 1, y, y + 1}, std::abs(height));
+}
+
+void init_grid(){
+    heights.current().fill(0.0f);
+    markChanged(0, width, 0, height);
+    // The previous level is left as it was, so every tile is stepped once
+    wakeAllTiles();
+}
+
+// Function to get surface normal at a point
+glm::vec3 getSurfaceNormal(int x, int y) {
+    const HeightField& height_current = heights.current();
+    float ddx = (height_current(x+1, y) - height_current(x-1, y)) / (2.0f * dx);
+    float ddy = (height_current(x, y+1) - height_current(x, y-1)) / (2.0f * dx);
+    glm::vec3 n(-ddx, -ddy, 1.0f);
+    return glm::normalize(n);
+}
+
+// Reallocates the simulation grids for a new resolution; the water is flat
+// afterwards
+void resize_grid(int newWidth, int newHeight){
+    width = newWidth;
+    height = newHeight;
+    heights.resize(width, height);
+    blockedPrev.resize(width, height);
+    markChanged(0, width, 0, height);
+    wakeAllTiles();
+}
+
+// Starting splashes, placed relative to the grid size
+void add_initial_disturbances(){
+    add_disturbance(width / 4, height / 4, 2.0f);
+    add_disturbance(width * 3 / 4, height * 3 / 4, 1.5f);
+    add_disturbance(width * 3 / 8, height * 5 / 8, 1.8f);
+}
+
+float getInterpolatedHeight(int x, int y, float alpha){
+    return heights.prev()(x, y) * (1.0f - alpha) + heights.current()(x, y) * alpha;
+}
+
+glm::vec3 getSurfaceNormal(int x, int y, float alpha) {
+    float ddx = (getInterpolatedHeight(x+1, y, alpha) - getInterpolatedHeight(x-1, y, alpha)) / (2.0f * dx);
+    float ddy = (getInterpolatedHeight(x, y+1, alpha) - getInterpolatedHeight(x, y-1, alpha)) / (2.0f * dx);
+    glm::vec3 n(-ddx, -ddy, 1.0f);
+    return glm::normalize(n);
+}
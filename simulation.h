@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <glm/glm.hpp>
+#include "heightfield.h"
+#include "thread_pool.h"
+#include "wave_kernels.h"
+
+// Water simulation parameters
+extern int width;
+extern int height;
+extern float dx;
+extern float dt;
+extern float c;
+extern float damping;
+extern float waterScale;
+extern unsigned solverThreads;
+extern int solverBandRows;
+extern int temporalBlockSteps;
+extern int temporalBlockRows;
+extern float sparseEpsilon;
+
+// Water height grids for simulation (row i = x, column j = y)
+extern HeightFieldRing heights;
+
+// Physical constants
+const float WATER_IOR = 1.33f;  // Index of refraction for water
+const float AIR_IOR = 1.0f;     // Index of refraction for air
+const float BOTTOM_Z = -30.0f;  // Bottom surface Z coordinate (deeper for larger scale)
+
+// Stencil kernel for the widest SIMD instruction set this CPU supports
+extern const SimdIsa waveKernelIsa;
+
+// Worker pool shared by the solver, created on first use
+ThreadPool& solverPool();
+
+// Fixed-timestep scheduler for the solver. Real frame time accumulates and
+// is spent in whole ticks of 1/rate seconds. At most maxSubsteps ticks run
+// per frame; any backlog beyond that is dropped, so a solver that falls
+// behind slows the simulation down instead of stretching the frame.
+struct FixedTimestep {
+    double rate = 60.0;      // Solver ticks per second of real time
+    int maxSubsteps = 4;     // Upper bound on ticks per frame
+    double accumulator = 0.0;
+
+    // Adds a frame's worth of time and returns the number of ticks to run
+    int advance(double frameSeconds) {
+        const double tick = 1.0 / rate;
+        accumulator += frameSeconds;
+        int steps = static_cast<int>(accumulator / tick);
+        if (steps > maxSubsteps) {
+            steps = maxSubsteps;
+            accumulator = std::fmod(accumulator, tick);
+        } else {
+            accumulator -= steps * tick;
+        }
+        return steps;
+    }
+
+    // How far the renderer is between the previous and current tick (0..1)
+    float alpha() const {
+        return static_cast<float>(std::min(std::max(accumulator * rate, 0.0), 1.0));
+    }
+};
+
+// Rectangle of grid vertices, rows [rowBegin, rowEnd) x columns [colBegin, colEnd)
+struct GridRegion {
+    int rowBegin = 0, rowEnd = 0;
+    int colBegin = 0, colEnd = 0;
+    bool empty() const { return rowBegin >= rowEnd || colBegin >= colEnd; }
+};
+
+// Part of the current height field that changed since the last call, for
+// caches derived from it (see height_mip.h). Every function below that
+// writes heights records what it touched.
+GridRegion takeChangedRegion();
+
+// Sparse stepping. The grid is split into ACTIVE_TILE_SIZE square tiles.
+// With sparseEpsilon > 0 a tile is energetic while some height in its
+// current or previous time level exceeds the epsilon in magnitude, and only
+// energetic tiles plus a one-tile halo (the active tiles) are stepped.
+// Waves move at most one cell per step, so the halo catches them before they
+// leave the active set. Tiles that drop out of it are snapped to exactly
+// zero, so every inactive tile is flat in all time levels.
+const int ACTIVE_TILE_SIZE = 32;
+
+struct ActiveTiles {
+    int rows = 0;                       // Tiles along i
+    int cols = 0;                       // Tiles along j
+    std::vector<unsigned char> active;  // Row-major over rows x cols
+
+    bool at(int ti, int tj) const { return active[ti * cols + tj] != 0; }
+    int count() const { return static_cast<int>(std::count(active.begin(), active.end(), 1)); }
+};
+
+// Tiles that may hold waves; every tile while sparse stepping is off
+const ActiveTiles& activeTiles();
+
+// Smooth radial splash in grid coordinates (x along rows i, y along
+// columns j). Adds amplitude * (1 - r^2 / radius^2)^3 to every cell within
+// radius cells of the centre.
+struct Disturbance {
+    float x = 0.0f;
+    float y = 0.0f;
+    float radius = 1.0f;
+    float amplitude = 0.0f;
+};
+
+// Disturbance queue. Any thread may queue disturbances without locking;
+// the solver applies everything queued at the start of its next step.
+// Returns how many were queued; the rest are dropped when the queue is full.
+std::size_t queue_disturbances(const Disturbance* events, std::size_t count);
+bool queue_disturbance(const Disturbance& event);
+
+// Applies everything queued so far; update_wave() and update_wave_blocked()
+// start with this. Solver thread only.
+void apply_queued_disturbances();
+
+// Stamps disturbances into the current level right away, in order.
+// Solver thread only.
+void stamp_disturbances(const Disturbance* events, std::size_t count);
+
+void update_wave();
+void update_wave_blocked(int steps);
+void update_wave_steps(int steps);
+void add_disturbance(int x, int y, float height);
+void add_initial_disturbances();
+void init_grid();
+void resize_grid(int newWidth, int newHeight);
+glm::vec3 getSurfaceNormal(int x, int y);
+
+// Height and normal of the field blended between the previous (alpha = 0)
+// and current (alpha = 1) time levels, for rendering between solver ticks
+float getInterpolatedHeight(int x, int y, float alpha);
+glm::vec3 getSurfaceNormal(int x, int y, float alpha);
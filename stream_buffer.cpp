@@ -0,0 +1,122 @@
+#include "stream_buffer.h"
+
+#include <cstring>
+#include <iostream>
+
+static bool supportsBufferStorage() {
+    if (!glBufferStorage) {
+        return false;
+    }
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major > 4 || (major == 4 && minor >= 4)) {
+        return true;
+    }
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StreamBuffer::create(std::size_t regionSize, int regionCount, bool allowPersistent) {
+    destroy();
+    if (regionCount < 1 || regionCount > static_cast<int>(sizeof(fences) / sizeof(fences[0]))) {
+        std::cerr << "StreamBuffer: unsupported region count " << regionCount << std::endl;
+        return false;
+    }
+
+    regionBytes = regionSize;
+    regions = regionCount;
+    // Start on the last region so the first beginWrite() lands on region 0
+    region = regions - 1;
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    GLsizeiptr totalBytes = static_cast<GLsizeiptr>(regionBytes * regions);
+
+    if (allowPersistent && supportsBufferStorage()) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, totalBytes, NULL, flags);
+        mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, totalBytes, flags);
+        if (mapped) {
+            return true;
+        }
+        // Storage is immutable now; start over with a plain buffer
+        std::cerr << "StreamBuffer: persistent mapping failed, falling back to orphaning" << std::endl;
+        glDeleteBuffers(1, &vbo);
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    }
+
+    glBufferData(GL_ARRAY_BUFFER, totalBytes, NULL, GL_STREAM_DRAW);
+    return true;
+}
+
+void StreamBuffer::destroy() {
+    for (GLsync& sync : fences) {
+        if (sync) {
+            glDeleteSync(sync);
+            sync = nullptr;
+        }
+    }
+    if (vbo) {
+        if (mapped) {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            mapped = nullptr;
+        }
+        glDeleteBuffers(1, &vbo);
+        vbo = 0;
+    }
+}
+
+void* StreamBuffer::beginWrite() {
+    region = (region + 1) % regions;
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    if (mapped) {
+        // Wait until the GPU has finished with the last draws from this region
+        if (GLsync sync = fences[region]) {
+            GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            while (result == GL_TIMEOUT_EXPIRED) {
+                result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+            }
+            glDeleteSync(sync);
+            fences[region] = nullptr;
+        }
+        return static_cast<char*>(mapped) + offset();
+    }
+
+    // Orphan the buffer when the ring wraps; every region handed out after
+    // that lives in storage the GPU is no longer using
+    if (region == 0) {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(regionBytes * regions), NULL, GL_STREAM_DRAW);
+    }
+    return glMapBufferRange(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset()), static_cast<GLsizeiptr>(regionBytes),
+                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void StreamBuffer::endWrite() {
+    if (!mapped) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+}
+
+void StreamBuffer::fence() {
+    if (!mapped) {
+        return;
+    }
+    // A region can be drawn on several frames while no new data arrives, so
+    // the fence always tracks the latest use
+    if (fences[region]) {
+        glDeleteSync(fences[region]);
+    }
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+// Vertex buffer for data that is rewritten every frame. The buffer is split
+// into a ring of regions so the CPU writes one region while the GPU may
+// still be reading the others.
+//
+// Where GL 4.4 / ARB_buffer_storage is available the whole buffer is mapped
+// once, persistently and coherently, and each region is guarded by a fence
+// that is waited on before the region is reused. Otherwise each region is
+// mapped unsynchronized and the buffer is orphaned whenever the ring wraps,
+// which lets the driver hand out fresh storage instead of stalling.
+class StreamBuffer {
+public:
+    static constexpr int kDefaultRegions = 3;
+
+    StreamBuffer() = default;
+    ~StreamBuffer() { destroy(); }
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Allocates regionCount regions of regionSize bytes. Set
+    // allowPersistent to false to force the orphaning path.
+    bool create(std::size_t regionSize, int regionCount = kDefaultRegions, bool allowPersistent = true);
+    void destroy();
+
+    // Moves to the next region and returns a write pointer to it. The buffer
+    // is left bound to GL_ARRAY_BUFFER.
+    void* beginWrite();
+    // Finishes the write started by beginWrite()
+    void endWrite();
+    // Call after the draws that read the current region have been issued
+    void fence();
+
+    unsigned int buffer() const { return vbo; }
+    // Byte offset of the most recently written region, for attribute pointers
+    std::size_t offset() const { return static_cast<std::size_t>(region) * regionBytes; }
+    bool persistent() const { return mapped != nullptr; }
+    // Index of the most recently written region. Only the persistent path
+    // keeps a region's contents until it is written again.
+    int currentRegion() const { return region; }
+    int regionCount() const { return regions; }
+
+private:
+    unsigned int vbo = 0;
+    std::size_t regionBytes = 0;
+    int regions = 0;
+    int region = 0;
+    void* mapped = nullptr;      // Persistent mapping of the whole buffer
+    GLsync fences[8] = {};
+};
@@ -0,0 +1,89 @@
+// Checks the CPU caustics reference on a grid other than the default:
+// flat water lights its whole footprint with a ratio of 1, the grid-derived
+// bounds hold all of it, and a perturbed surface moves light around without
+// creating or losing any.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "caustics_map.h"
+#include "simulation.h"
+
+static double total(const std::vector<float>& map) {
+    double sum = 0.0;
+    for (float value : map) {
+        sum += value;
+    }
+    return sum;
+}
+
+int main() {
+    const int mapSize = 256;
+    const glm::vec3 lightPos(0.0f, 0.0f, 100.0f);
+    int failures = 0;
+
+    // Larger than the default pool, so the fixed range would clip it
+    resize_grid(300, 260);
+    const CausticsMapBounds bounds = poolCausticsBounds(lightPos);
+    if (bounds.min > -150.0f * waterScale || bounds.min + bounds.size < 150.0f * waterScale) {
+        std::cerr << "bounds " << bounds.min << " + " << bounds.size << " do not cover the pool" << std::endl;
+        ++failures;
+    }
+
+    // Flat water: every lit pixel gets exactly one triangle's ratio of 1,
+    // apart from pixel centres lying on a shared edge
+    std::vector<float> flat;
+    computeCausticsMap(flat, mapSize, mapSize, bounds, lightPos);
+    int lit = 0, other = 0;
+    for (float value : flat) {
+        if (value == 1.0f) {
+            ++lit;
+        } else if (value != 0.0f) {
+            ++other;
+        }
+    }
+    if (lit == 0 || other > lit / 100) {
+        std::cerr << "flat water: " << lit << " pixels at 1, " << other << " at other values" << std::endl;
+        ++failures;
+    }
+
+    // The border of the map stays dark, so no light fell outside it
+    auto borderLight = [&](const std::vector<float>& map) {
+        double sum = 0.0;
+        for (int k = 0; k < mapSize; ++k) {
+            sum += map[k] + map[static_cast<size_t>(mapSize - 1) * mapSize + k];
+            sum += map[static_cast<size_t>(k) * mapSize] + map[static_cast<size_t>(k) * mapSize + mapSize - 1];
+        }
+        return sum;
+    };
+    if (borderLight(flat) != 0.0) {
+        std::cerr << "flat water lights the map border" << std::endl;
+        ++failures;
+    }
+
+    // Gentle waves focus light into caustics but keep the total
+    for (int i = 1; i < width - 1; ++i) {
+        for (int j = 1; j < height - 1; ++j) {
+            heights.current()(i, j) = 0.4f * std::sin(i * 0.19f) * std::cos(j * 0.23f);
+        }
+    }
+    std::vector<float> waves;
+    computeCausticsMap(waves, mapSize, mapSize, bounds, lightPos);
+    float brightest = 0.0f;
+    for (float value : waves) {
+        brightest = std::max(brightest, value);
+    }
+    const double flatTotal = total(flat);
+    const double wavesTotal = total(waves);
+    const double drift = std::fabs(wavesTotal - flatTotal) / flatTotal;
+    if (drift > 0.01 || brightest <= 1.0f || borderLight(waves) != 0.0) {
+        std::cerr << "waves: total " << wavesTotal << " against " << flatTotal << " for flat water, brightest "
+                  << brightest << std::endl;
+        ++failures;
+    }
+
+    std::cout << lit << " lit pixels at 1 (" << other << " on edges), energy drift " << drift * 100.0
+              << "%, brightest " << brightest << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+// Guards the min/max height pyramid: intersectHeightField() must find the
+// same nearest hit as testing every cell, for random and grazing rays, and
+// updating the pyramid incrementally must match a full rebuild.
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include "height_mip.h"
+
+// Moller-Trumbore, written out independently of height_mip.cpp
+static bool hitTriangle(const glm::vec3& origin, const glm::vec3& direction,
+                        const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t) {
+    glm::vec3 edge1 = b - a;
+    glm::vec3 edge2 = c - a;
+    glm::vec3 p = glm::cross(direction, edge2);
+    float det = glm::dot(edge1, p);
+    if (std::fabs(det) < 1e-12f) {
+        return false;
+    }
+    glm::vec3 s = origin - a;
+    float u = glm::dot(s, p) / det;
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = glm::dot(direction, q) / det;
+    if (u < 0.0f || v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    t = glm::dot(edge2, q) / det;
+    return true;
+}
+
+// Nearest hit over the two triangles of every cell, as the water mesh splits them
+static bool bruteForceHit(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax, float& tHit) {
+    const HeightField& field = heights.current();
+    bool found = false;
+    tHit = tMax;
+    for (int i = 0; i + 1 < width; ++i) {
+        for (int j = 0; j + 1 < height; ++j) {
+            glm::vec3 topLeft(float(i), float(j), field(i, j));
+            glm::vec3 topRight(float(i), float(j + 1), field(i, j + 1));
+            glm::vec3 bottomLeft(float(i + 1), float(j), field(i + 1, j));
+            glm::vec3 bottomRight(float(i + 1), float(j + 1), field(i + 1, j + 1));
+            float t;
+            if (hitTriangle(origin, direction, topLeft, bottomLeft, topRight, t) && t >= tMin && t <= tHit) {
+                tHit = t;
+                found = true;
+            }
+            if (hitTriangle(origin, direction, topRight, bottomLeft, bottomRight, t) && t >= tMin && t <= tHit) {
+                tHit = t;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+static bool sameMip(const HeightMinMaxMip& a, const HeightMinMaxMip& b) {
+    if (a.levels() != b.levels()) {
+        return false;
+    }
+    for (int level = 0; level < a.levels(); ++level) {
+        if (a.rows(level) != b.rows(level) || a.cols(level) != b.cols(level)) {
+            return false;
+        }
+        for (int i = 0; i < a.rows(level); ++i) {
+            for (int j = 0; j < a.cols(level); ++j) {
+                if (a.node(level, i, j).low != b.node(level, i, j).low ||
+                    a.node(level, i, j).high != b.node(level, i, j).high) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Rolling waves plus per-vertex noise, so neighbouring cells differ
+static void fillWaves(std::mt19937& random) {
+    std::uniform_real_distribution<float> noise(-0.3f, 0.3f);
+    HeightField& field = heights.current();
+    for (int i = 0; i < width; ++i) {
+        for (int j = 0; j < height; ++j) {
+            field(i, j) = 2.0f * std::sin(i * 0.21f) * std::cos(j * 0.17f) + noise(random);
+        }
+    }
+}
+
+static int checkRays(std::mt19937& random) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float pi = 3.14159265f;
+    HeightMinMaxMip mip;
+    mip.build(heights.current());
+
+    int failures = 0;
+    int hits = 0;
+    const int rayCount = 2000;
+    for (int r = 0; r < rayCount; ++r) {
+        glm::vec3 origin, direction;
+        if (r % 2 == 0) {
+            // From above the water in any downward direction
+            origin = glm::vec3(unit(random) * width, unit(random) * height, 3.0f + unit(random) * 5.0f);
+            glm::vec3 target(unit(random) * width, unit(random) * height, -3.0f);
+            direction = glm::normalize(target - origin);
+        } else {
+            // Grazing: nearly horizontal, starting outside the grid at wave height
+            float angle = unit(random) * 2.0f * pi;
+            glm::vec3 centre(width * 0.5f, height * 0.5f, 0.0f);
+            float reach = float(width + height);
+            origin = centre - reach * glm::vec3(std::cos(angle), std::sin(angle), 0.0f);
+            origin.z = (unit(random) * 2.0f - 1.0f) * 2.5f;
+            direction = glm::normalize(glm::vec3(std::cos(angle), std::sin(angle), (unit(random) - 0.5f) * 0.02f));
+        }
+        // Axis-aligned rays exercise the huge inverse direction
+        if (r % 97 == 0) {
+            direction = glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f));
+        } else if (r % 89 == 0) {
+            direction = glm::vec3(direction.x > 0.0f ? 1.0f : -1.0f, 0.0f, 0.0f);
+        }
+
+        const float tMax = std::numeric_limits<float>::max();
+        float expected = 0.0f, actual = 0.0f;
+        glm::vec3 normal;
+        bool expectedHit = bruteForceHit(origin, direction, 0.0f, tMax, expected);
+        bool actualHit = intersectHeightField(mip, origin, direction, 0.0f, tMax, actual, normal);
+        hits += expectedHit ? 1 : 0;
+        if (expectedHit != actualHit ||
+            (expectedHit && std::fabs(expected - actual) > 1e-4f * std::max(1.0f, expected))) {
+            std::cerr << "ray " << r << ": brute force " << (expectedHit ? "hits at " : "misses ") << expected
+                      << ", pyramid " << (actualHit ? "hits at " : "misses ") << actual << std::endl;
+            ++failures;
+        }
+    }
+    std::cout << rayCount << " rays checked on " << width << "x" << height << " (" << hits << " hits), "
+              << failures << " mismatches" << std::endl;
+    return failures;
+}
+
+static int checkUpdates(std::mt19937& random) {
+    int failures = 0;
+
+    // update() with rectangles of every shape, border ones included
+    HeightMinMaxMip incremental;
+    incremental.build(heights.current());
+    std::uniform_real_distribution<float> value(-3.0f, 3.0f);
+    for (int round = 0; round < 200; ++round) {
+        GridRegion region;
+        region.rowBegin = std::uniform_int_distribution<int>(0, width - 1)(random);
+        region.rowEnd = std::uniform_int_distribution<int>(region.rowBegin + 1, std::min(width, region.rowBegin + 40))(random);
+        region.colBegin = std::uniform_int_distribution<int>(0, height - 1)(random);
+        region.colEnd = std::uniform_int_distribution<int>(region.colBegin + 1, std::min(height, region.colBegin + 40))(random);
+        if (round % 10 == 0) {
+            region = {width - 1, width, height - 1, height};  // The last vertex only
+        }
+        for (int i = region.rowBegin; i < region.rowEnd; ++i) {
+            for (int j = region.colBegin; j < region.colEnd; ++j) {
+                heights.current()(i, j) = value(random);
+            }
+        }
+        incremental.update(heights.current(), region);
+
+        HeightMinMaxMip full;
+        full.build(heights.current());
+        if (!sameMip(incremental, full)) {
+            std::cerr << "update() of rows " << region.rowBegin << "-" << region.rowEnd << ", columns "
+                      << region.colBegin << "-" << region.colEnd << " differs from a rebuild" << std::endl;
+            ++failures;
+        }
+    }
+
+    // refresh() driven by the regions the solver reports
+    surfaceMip().refresh();
+    for (int round = 0; round < 50; ++round) {
+        if (round % 5 == 0) {
+            Disturbance splash;
+            splash.x = std::uniform_real_distribution<float>(0.0f, float(width))(random);
+            splash.y = std::uniform_real_distribution<float>(0.0f, float(height))(random);
+            splash.radius = 4.0f;
+            splash.amplitude = 1.0f;
+            stamp_disturbances(&splash, 1);
+        } else if (round % 5 == 1) {
+            add_disturbance(width - 1, height / 2, value(random));
+        } else {
+            update_wave();
+        }
+        surfaceMip().refresh();
+
+        HeightMinMaxMip full;
+        full.build(heights.current());
+        if (!sameMip(surfaceMip(), full)) {
+            std::cerr << "refresh() after round " << round << " differs from a rebuild" << std::endl;
+            ++failures;
+        }
+    }
+
+    std::cout << "incremental updates on " << width << "x" << height << ": " << failures << " mismatches" << std::endl;
+    return failures;
+}
+
+int main() {
+    std::mt19937 random(7);
+    int failures = 0;
+
+    // Odd sizes leave partial nodes on every level
+    const int sizes[][2] = {{64, 64}, {77, 53}, {2, 9}};
+    for (const auto& size : sizes) {
+        resize_grid(size[0], size[1]);
+        fillWaves(random);
+        failures += checkRays(random);
+        failures += checkUpdates(random);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// Checks the disturbance path: the multi-producer ring keeps each producer's
+// values in order across wrap-arounds, a full ring reports how much of a
+// batch fit, and the SIMD stamp kernels match stampRowScalar.
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "mpsc_queue.h"
+#include "wave_kernels.h"
+
+// Producers push batches concurrently while one consumer pops; every
+// producer's values must arrive complete and in order
+static int checkProducers() {
+    MpscQueue<long> queue(1000);  // Rounded up to 1024
+    const int producerCount = 4;
+    const long perProducer = 100000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerCount; ++p) {
+        producers.emplace_back([&queue, p, perProducer] {
+            long batch[7];
+            long sent = 0;
+            while (sent < perProducer) {
+                const long count = std::min(7L, perProducer - sent);
+                for (long k = 0; k < count; ++k) {
+                    batch[k] = p * perProducer + sent + k;
+                }
+                const std::size_t pushed = queue.push(batch, static_cast<std::size_t>(count));
+                sent += static_cast<long>(pushed);
+                if (pushed == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<long> last(producerCount, -1);
+    long received = 0;
+    long outOfOrder = 0;
+    long value;
+    while (received < producerCount * perProducer) {
+        if (!queue.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const int p = static_cast<int>(value / perProducer);
+        if (value % perProducer != last[p] + 1) {
+            ++outOfOrder;
+        }
+        last[p] = value % perProducer;
+        ++received;
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    int failures = 0;
+    if (queue.capacity() != 1024) {
+        std::cerr << "capacity " << queue.capacity() << ", expected 1024" << std::endl;
+        ++failures;
+    }
+    if (outOfOrder != 0 || queue.pop(value)) {
+        std::cerr << outOfOrder << " values out of order or left over" << std::endl;
+        ++failures;
+    }
+    std::cout << received << " values from " << producerCount << " producers, " << outOfOrder
+              << " out of order" << std::endl;
+    return failures;
+}
+
+// One thread, exact counts: partial batches on a full ring and many laps
+// around the slots
+static int checkFullRing() {
+    int failures = 0;
+    MpscQueue<int> queue(6);  // Rounded up to 8
+    if (queue.capacity() != 8) {
+        std::cerr << "capacity " << queue.capacity() << ", expected 8" << std::endl;
+        ++failures;
+    }
+
+    int values[10];
+    for (int k = 0; k < 10; ++k) {
+        values[k] = k;
+    }
+    // 5 fit, then 3 of the next 5, then nothing
+    if (queue.push(values, 5) != 5 || queue.push(values + 5, 5) != 3 || queue.push(values, 1) != 0 ||
+        queue.push(values[0])) {
+        std::cerr << "full ring accepted the wrong number of values" << std::endl;
+        ++failures;
+    }
+    int value;
+    for (int k = 0; k < 8; ++k) {
+        if (!queue.pop(value) || value != k) {
+            std::cerr << "pop " << k << " returned the wrong value" << std::endl;
+            ++failures;
+        }
+    }
+    if (queue.pop(value)) {
+        std::cerr << "empty ring returned a value" << std::endl;
+        ++failures;
+    }
+
+    // Keep a few values in flight so positions wrap the ring many times
+    int next = 0, expected = 0;
+    for (int round = 0; round < 1000; ++round) {
+        int batch[3] = {next, next + 1, next + 2};
+        const std::size_t pushed = queue.push(batch, 3);
+        next += static_cast<int>(pushed);
+        for (int k = 0; k < 2 && queue.pop(value); ++k) {
+            if (value != expected++) {
+                std::cerr << "value " << value << " after wrap-around, expected " << expected - 1 << std::endl;
+                ++failures;
+                round = 1000;
+                break;
+            }
+        }
+    }
+    while (queue.pop(value)) {
+        if (value != expected++) {
+            ++failures;
+        }
+    }
+    if (expected != next) {
+        std::cerr << "popped " << expected << " of " << next << " pushed values" << std::endl;
+        ++failures;
+    }
+    std::cout << next << " values through an " << queue.capacity() << "-slot ring, " << failures
+              << " failures" << std::endl;
+    return failures;
+}
+
+// Every stamp kernel this CPU supports writes the same bits as the scalar one
+static int checkStampKernels() {
+    const SimdIsa widest = detectSimdIsa();
+    const SimdIsa isas[] = {SimdIsa::SSE, SimdIsa::AVX2, SimdIsa::AVX512};
+    std::mt19937 random(99);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    int failures = 0;
+    int checked = 0;
+
+    for (SimdIsa isa : isas) {
+        if (static_cast<int>(isa) > static_cast<int>(widest)) {
+            continue;
+        }
+        const StampRowKernel kernel = getStampRowKernel(isa);
+        for (int trial = 0; trial < 200; ++trial) {
+            const int cols = 1 + static_cast<int>(unit(random) * 80);
+            const int begin = static_cast<int>(unit(random) * cols);
+            const int end = begin + static_cast<int>(unit(random) * (cols - begin + 1));
+            const float radius = 0.5f + unit(random) * 20.0f;
+            const float center = unit(random) * cols;
+            const float rowOffset2 = unit(random) * radius * radius;
+            const float amplitude = unit(random) * 4.0f - 2.0f;
+
+            std::vector<float> expected(cols), actual(cols);
+            for (int j = 0; j < cols; ++j) {
+                expected[j] = actual[j] = unit(random) - 0.5f;
+            }
+            stampRowScalar(expected.data(), begin, end, center, rowOffset2, 1.0f / (radius * radius), amplitude);
+            kernel(actual.data(), begin, end, center, rowOffset2, 1.0f / (radius * radius), amplitude);
+            ++checked;
+            if (std::memcmp(expected.data(), actual.data(), cols * sizeof(float)) != 0) {
+                std::cerr << simdIsaName(isa) << ": columns " << begin << "-" << end
+                          << " differ from the scalar stamp" << std::endl;
+                ++failures;
+            }
+        }
+    }
+    std::cout << checked << " stamp rows checked, " << failures << " mismatches" << std::endl;
+    return failures;
+}
+
+int main() {
+    int failures = checkProducers();
+    failures += checkFullRing();
+    failures += checkStampKernels();
+    return failures == 0 ? 0 : 1;
+}
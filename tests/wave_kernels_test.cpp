@@ -0,0 +1,57 @@
+// Checks that every SIMD wave stencil kernel this CPU supports produces the
+// same bits as waveRowScalar, including the scalar tails after the last
+// full vector.
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "wave_kernels.h"
+
+int main() {
+    const SimdIsa widest = detectSimdIsa();
+    const SimdIsa isas[] = {SimdIsa::SSE, SimdIsa::AVX2, SimdIsa::AVX512};
+    const int lengths[] = {1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 63, 200};
+    const float keep = 0.99f;
+    const float coeff = 0.49f;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+    int failures = 0;
+    int checked = 0;
+
+    for (SimdIsa isa : isas) {
+        if (static_cast<int>(isa) > static_cast<int>(widest)) {
+            std::cout << simdIsaName(isa) << ": not supported, skipped" << std::endl;
+            continue;
+        }
+        const WaveRowKernel kernel = getWaveRowKernel(isa);
+        for (int length : lengths) {
+            // Different starting columns move the vector loop off alignment
+            for (int begin = 1; begin <= 3; ++begin) {
+                const int cols = begin + length + 1;
+                std::vector<float> up(cols), mid(cols), down(cols), prev(cols);
+                for (int j = 0; j < cols; ++j) {
+                    up[j] = value(random);
+                    mid[j] = value(random);
+                    down[j] = value(random);
+                    prev[j] = value(random);
+                }
+                std::vector<float> expected(cols, 0.0f), actual(cols, 0.0f);
+                waveRowScalar(up.data(), mid.data(), down.data(), prev.data(), expected.data(),
+                              begin, begin + length, keep, coeff);
+                kernel(up.data(), mid.data(), down.data(), prev.data(), actual.data(),
+                       begin, begin + length, keep, coeff);
+                ++checked;
+                if (std::memcmp(expected.data(), actual.data(), cols * sizeof(float)) != 0) {
+                    std::cerr << simdIsaName(isa) << ": length " << length << " from column " << begin
+                              << " differs from the scalar kernel" << std::endl;
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    std::cout << checked << " rows checked, " << failures << " mismatches" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
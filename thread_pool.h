@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of worker threads. Workers are created once and sleep
+// between jobs, so dispatching work every frame costs a wake-up rather than
+// a thread spawn. The calling thread always takes part in the work.
+class ThreadPool {
+public:
+    // threadCount includes the calling thread; 0 means one per hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that execute work, including the caller
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Runs fn(index) for every index in [0, count) and blocks until all of
+    // them have finished. Indices are handed out dynamically, so uneven
+    // work items balance across threads.
+    void parallelFor(int count, const std::function<void(int)>& fn);
+
+private:
+    void workerLoop();
+    void runIndices();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Current job, guarded by mutex for publication
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextIndex{0};
+    unsigned generation = 0;
+    unsigned busyWorkers = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free single-producer / single-consumer triple buffer. The producer
+// fills writeBuffer() and publish()es it; the consumer acquire()s the most
+// recently published slot and reads it through readBuffer(). Neither side
+// ever waits for the other: the producer always owns one slot, the consumer
+// owns one, and the third is handed across with an atomic exchange.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer side
+    T& writeBuffer() { return slots[backIndex]; }
+
+    void publish() {
+        unsigned previous = middle.exchange(backIndex | kFresh, std::memory_order_acq_rel);
+        backIndex = previous & kIndexMask;
+    }
+
+    // True while the last published slot has not been picked up yet
+    bool hasPending() const {
+        return (middle.load(std::memory_order_acquire) & kFresh) != 0;
+    }
+
+    // Consumer side: switches to the newest published slot, if there is
+    // one. Returns false when nothing new arrived since the last call.
+    bool acquire() {
+        if ((middle.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        unsigned previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & kIndexMask;
+        return true;
+    }
+
+    const T& readBuffer() const { return slots[frontIndex]; }
+
+private:
+    static constexpr unsigned kIndexMask = 3;
+    static constexpr unsigned kFresh = 4;
+
+    T slots[3];
+    std::atomic<unsigned> middle{1};
+    unsigned backIndex = 0;  // Owned by the producer
+    unsigned frontIndex = 2; // Owned by the consumer
+};
@@ -0,0 +1,250 @@
+#include "water_chunks.h"
+
+#include <algorithm>
+#include <cmath>
+
+void WaterDrawList::clear() {
+    counts.clear();
+    offsets.clear();
+    baseVertices.clear();
+    triangles = 0;
+    chunks = 0;
+}
+
+// Positions of the grid lines a chunk keeps along one axis at the given
+// step: every step-th line, plus the far edge
+static std::vector<int> gridLines(int length, int step) {
+    std::vector<int> lines;
+    for (int t = 0; t < length; t += step) {
+        lines.push_back(t);
+    }
+    lines.push_back(length);
+    return lines;
+}
+
+void WaterChunkMesh::build(int gridRows, int cols, int chunkQuads, float scale, float lowZ, float highZ) {
+    gridCols = cols;
+    chunkQuads = std::max(chunkQuads, 2);
+    // The coarsest level still leaves two steps across a full chunk
+    levels = 1;
+    while ((2 << levels) <= chunkQuads) {
+        ++levels;
+    }
+
+    // Chunk origins along one axis; the last chunk takes the remainder
+    auto split = [chunkQuads](int quads) {
+        std::vector<int> starts;
+        int count = std::max(quads / chunkQuads, 1);
+        for (int k = 0; k < count; ++k) {
+            starts.push_back(k * chunkQuads);
+        }
+        starts.push_back(quads);
+        return starts;
+    };
+    std::vector<int> startsI = split(gridRows - 1);
+    std::vector<int> startsJ = split(cols - 1);
+    chunksI = static_cast<int>(startsI.size()) - 1;
+    chunksJ = static_cast<int>(startsJ.size()) - 1;
+
+    chunks.clear();
+    shapes.clear();
+    patternIndices.clear();
+    for (int ci = 0; ci < chunksI; ++ci) {
+        for (int cj = 0; cj < chunksJ; ++cj) {
+            Chunk chunk;
+            chunk.i0 = startsI[ci];
+            chunk.j0 = startsJ[cj];
+            chunk.shape = findShape(startsI[ci + 1] - chunk.i0, startsJ[cj + 1] - chunk.j0);
+            chunk.boundsMin = glm::vec3((startsI[ci] - gridRows / 2.0f) * scale,
+                                        (startsJ[cj] - cols / 2.0f) * scale, lowZ);
+            chunk.boundsMax = glm::vec3((startsI[ci + 1] - gridRows / 2.0f) * scale,
+                                        (startsJ[cj + 1] - cols / 2.0f) * scale, highZ);
+            chunks.push_back(chunk);
+        }
+    }
+}
+
+// Index of the shape with this many quads, building its patterns the first
+// time it is seen
+int WaterChunkMesh::findShape(int rows, int cols) {
+    for (size_t s = 0; s < shapes.size(); ++s) {
+        if (shapes[s].rows == rows && shapes[s].cols == cols) {
+            return static_cast<int>(s);
+        }
+    }
+
+    ChunkShape shape;
+    shape.rows = rows;
+    shape.cols = cols;
+    while (shape.maxLevel + 1 < levels && (2 << (shape.maxLevel + 1)) <= std::min(rows, cols)) {
+        ++shape.maxLevel;
+    }
+    shape.interiors.resize(levels);
+    shape.strips.resize(static_cast<size_t>(levels) * levels * 4);
+    for (int level = 0; level <= shape.maxLevel; ++level) {
+        shape.interiors[level] = addInterior(shape, 1 << level);
+        // Neighbours of any shape may sit at any coarser level
+        for (int edgeLevel = level; edgeLevel < levels; ++edgeLevel) {
+            for (int side = 0; side < 4; ++side) {
+                shape.strips[stripIndex(level, edgeLevel, side)] = addStrip(shape, 1 << level, 1 << edgeLevel, side);
+            }
+        }
+    }
+    shapes.push_back(shape);
+    return static_cast<int>(shapes.size()) - 1;
+}
+
+// Quads between the chunk's inner grid lines, split like generateWaterIndices()
+WaterChunkMesh::IndexRange WaterChunkMesh::addInterior(const ChunkShape& shape, int step) {
+    IndexRange range;
+    range.first = static_cast<unsigned int>(patternIndices.size());
+    std::vector<int> u = gridLines(shape.rows, step);
+    std::vector<int> v = gridLines(shape.cols, step);
+    for (size_t a = 1; a + 2 < u.size(); ++a) {
+        for (size_t b = 1; b + 2 < v.size(); ++b) {
+            unsigned int topLeft = u[a] * gridCols + v[b];
+            unsigned int topRight = u[a] * gridCols + v[b + 1];
+            unsigned int bottomLeft = u[a + 1] * gridCols + v[b];
+            unsigned int bottomRight = u[a + 1] * gridCols + v[b + 1];
+
+            patternIndices.insert(patternIndices.end(), {topLeft, bottomLeft, topRight});
+            patternIndices.insert(patternIndices.end(), {topRight, bottomLeft, bottomRight});
+        }
+    }
+    range.count = static_cast<unsigned int>(patternIndices.size()) - range.first;
+    return range;
+}
+
+// Triangles between one chunk edge, sampled every edgeStep lines, and the
+// parallel inner grid line, sampled every step lines. Sides 0 and 1 are the
+// i = 0 and i = rows edges, sides 2 and 3 the j = 0 and j = cols edges. The
+// strips of adjacent sides meet on the diagonal through the chunk corner.
+WaterChunkMesh::IndexRange WaterChunkMesh::addStrip(const ChunkShape& shape, int step, int edgeStep, int side) {
+    IndexRange range;
+    range.first = static_cast<unsigned int>(patternIndices.size());
+
+    const bool alongJ = side < 2;
+    std::vector<int> u = gridLines(shape.rows, step);
+    std::vector<int> v = gridLines(shape.cols, step);
+    std::vector<int> edge = gridLines(alongJ ? shape.cols : shape.rows, edgeStep);
+    std::vector<int> inner(alongJ ? v.begin() + 1 : u.begin() + 1, alongJ ? v.end() - 1 : u.end() - 1);
+    int edgeLine, innerLine;
+    switch (side) {
+        case 0: edgeLine = 0; innerLine = u[1]; break;
+        case 1: edgeLine = shape.rows; innerLine = u[u.size() - 2]; break;
+        case 2: edgeLine = 0; innerLine = v[1]; break;
+        default: edgeLine = shape.cols; innerLine = v[v.size() - 2]; break;
+    }
+
+    // (i, j) of a point t along the edge or inner line
+    auto point = [&](int line, int t) { return alongJ ? glm::ivec2(line, t) : glm::ivec2(t, line); };
+    // Counter-clockwise in the x/y plane, like the rest of the grid
+    auto emit = [&](glm::ivec2 a, glm::ivec2 b, glm::ivec2 c) {
+        int cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (cross < 0) {
+            std::swap(b, c);
+        }
+        for (const glm::ivec2& p : {a, b, c}) {
+            patternIndices.push_back(p.x * gridCols + p.y);
+        }
+    };
+
+    // Merge the two sample rows by position; every step adds one triangle
+    size_t e = 0, n = 0;
+    while (e + 1 < edge.size() || n + 1 < inner.size()) {
+        bool advanceEdge = e + 1 < edge.size() && (n + 1 == inner.size() || edge[e + 1] <= inner[n + 1]);
+        if (advanceEdge) {
+            emit(point(edgeLine, edge[e]), point(edgeLine, edge[e + 1]), point(innerLine, inner[n]));
+            ++e;
+        } else {
+            emit(point(innerLine, inner[n]), point(innerLine, inner[n + 1]), point(edgeLine, edge[e]));
+            ++n;
+        }
+    }
+    range.count = static_cast<unsigned int>(patternIndices.size()) - range.first;
+    return range;
+}
+
+int WaterChunkMesh::clampLevel(const Chunk& chunk, int level) const {
+    return std::min(std::max(level, 0), shapes[chunk.shape].maxLevel);
+}
+
+void WaterChunkMesh::selectLevels(std::vector<int>& chunkLevels, const glm::mat4& viewProjection,
+                                  const glm::vec3& eye, float lodDistance, int minLevel) const {
+    // Frustum planes from the rows of the clip transform, pointing inwards
+    glm::vec4 row[4];
+    for (int r = 0; r < 4; ++r) {
+        row[r] = glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+    }
+    const glm::vec4 planes[6] = {row[3] + row[0], row[3] - row[0], row[3] + row[1],
+                                 row[3] - row[1], row[3] + row[2], row[3] - row[2]};
+
+    chunkLevels.resize(chunks.size());
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        const Chunk& chunk = chunks[c];
+        bool visible = true;
+        for (const glm::vec4& plane : planes) {
+            // Box corner furthest along the plane normal
+            glm::vec3 corner(plane.x >= 0.0f ? chunk.boundsMax.x : chunk.boundsMin.x,
+                             plane.y >= 0.0f ? chunk.boundsMax.y : chunk.boundsMin.y,
+                             plane.z >= 0.0f ? chunk.boundsMax.z : chunk.boundsMin.z);
+            if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f) {
+                visible = false;
+                break;
+            }
+        }
+        if (!visible) {
+            chunkLevels[c] = -1;
+            continue;
+        }
+
+        glm::vec3 nearest = glm::clamp(eye, chunk.boundsMin, chunk.boundsMax);
+        float distance = glm::length(eye - nearest);
+        int level = minLevel;
+        if (lodDistance > 0.0f && distance >= lodDistance) {
+            level = std::max(level, static_cast<int>(std::floor(std::log2(distance / lodDistance))) + 1);
+        }
+        chunkLevels[c] = clampLevel(chunk, level);
+    }
+}
+
+void WaterChunkMesh::buildDrawList(const std::vector<int>& chunkLevels, WaterDrawList& list) const {
+    list.clear();
+    auto append = [&](const IndexRange& range, int baseVertex) {
+        if (range.count == 0) {
+            return;
+        }
+        list.counts.push_back(static_cast<int>(range.count));
+        list.offsets.push_back(reinterpret_cast<const void*>(range.first * sizeof(unsigned int)));
+        list.baseVertices.push_back(baseVertex);
+        list.triangles += range.count / 3;
+    };
+    auto levelAt = [&](int ci, int cj) {
+        if (ci < 0 || cj < 0 || ci >= chunksI || cj >= chunksJ) {
+            return -1;
+        }
+        return chunkLevels[ci * chunksJ + cj];
+    };
+
+    for (int ci = 0; ci < chunksI; ++ci) {
+        for (int cj = 0; cj < chunksJ; ++cj) {
+            const int level = levelAt(ci, cj);
+            if (level < 0) {
+                continue;
+            }
+            const Chunk& chunk = chunks[ci * chunksJ + cj];
+            const ChunkShape& shape = shapes[chunk.shape];
+            const int baseVertex = chunk.i0 * gridCols + chunk.j0;
+            append(shape.interiors[level], baseVertex);
+
+            // Each edge takes the coarser level of the two chunks sharing it;
+            // culled neighbours draw nothing to match
+            const int neighbours[4] = {levelAt(ci - 1, cj), levelAt(ci + 1, cj), levelAt(ci, cj - 1),
+                                       levelAt(ci, cj + 1)};
+            for (int side = 0; side < 4; ++side) {
+                append(shape.strips[stripIndex(level, std::max(level, neighbours[side]), side)], baseVertex);
+            }
+            ++list.chunks;
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+// The water grid split into square chunks of quads, each drawable at a
+// level of detail that keeps every 2^level-th grid line. A chunk is an
+// interior grid at its own step plus four edge strips; a strip joins the
+// chunk's inner grid line to the edge sampled at the coarser step of the two
+// chunks sharing it, so neighbours at different levels meet without cracks.
+// Index patterns are relative to the chunk's first vertex and shared by all
+// chunks of the same size, so the whole set is built once and drawn with a
+// base vertex per chunk. Vertex (i, j) of the grid is i * cols + j.
+
+// Arrays for one glMultiDrawElementsBaseVertex call over 32-bit indices
+struct WaterDrawList {
+    std::vector<int> counts;
+    std::vector<const void*> offsets;  // Byte offsets into the index buffer
+    std::vector<int> baseVertices;
+    std::size_t triangles = 0;
+    int chunks = 0;                    // Chunks drawn
+
+    void clear();
+};
+
+class WaterChunkMesh {
+public:
+    static constexpr int kDefaultChunkQuads = 64;
+
+    // Chunks of chunkQuads quads per side, the last chunk along each axis
+    // taking the remainder. lowZ and highZ bound everything drawn with the
+    // grid (water and the flattened bottom) for culling.
+    void build(int gridRows, int gridCols, int chunkQuads, float scale, float lowZ, float highZ);
+
+    // Index patterns of every chunk size and level, for the element buffer
+    const std::vector<unsigned int>& indices() const { return patternIndices; }
+    int chunkCount() const { return static_cast<int>(chunks.size()); }
+    int levelCount() const { return levels; }
+
+    // One level per chunk: -1 for chunks outside the frustum of
+    // viewProjection, else one more level each time the distance from eye
+    // doubles past lodDistance (0 = no distance falloff), and at least
+    // minLevel. Levels are clamped to what each chunk supports.
+    void selectLevels(std::vector<int>& chunkLevels, const glm::mat4& viewProjection, const glm::vec3& eye,
+                      float lodDistance, int minLevel = 0) const;
+
+    // Draw arrays for the chunks at the given levels, skipping culled ones
+    void buildDrawList(const std::vector<int>& chunkLevels, WaterDrawList& list) const;
+
+private:
+    struct IndexRange {
+        unsigned int first = 0;
+        unsigned int count = 0;
+    };
+
+    // Patterns shared by all chunks of one size
+    struct ChunkShape {
+        int rows = 0;  // Quads along i
+        int cols = 0;  // Quads along j
+        int maxLevel = 0;
+        std::vector<IndexRange> interiors;  // By level
+        std::vector<IndexRange> strips;     // By (level, edge level, side)
+    };
+
+    struct Chunk {
+        int i0 = 0;
+        int j0 = 0;
+        int shape = 0;
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+    };
+
+    int findShape(int rows, int cols);
+    IndexRange addInterior(const ChunkShape& shape, int step);
+    IndexRange addStrip(const ChunkShape& shape, int step, int edgeStep, int side);
+    int stripIndex(int level, int edgeLevel, int side) const { return (level * levels + edgeLevel) * 4 + side; }
+    int clampLevel(const Chunk& chunk, int level) const;
+
+    int gridCols = 0;
+    int chunksI = 0;
+    int chunksJ = 0;
+    int levels = 1;
+    std::vector<Chunk> chunks;  // Row-major over chunksI x chunksJ
+    std::vector<ChunkShape> shapes;
+    std::vector<unsigned int> patternIndices;
+};
@@ -0,0 +1,161 @@
+#include "water_mesh.h"
+#include "simulation.h"
+
+#include <algorithm>
+
+void generateWaterGridXY(std::vector<float>& positions) {
+    positions.clear();
+    positions.reserve(static_cast<size_t>(width) * height * 2);
+
+    for (int i = 0; i < width; i++) {
+        for (int j = 0; j < height; j++) {
+            // Position (scaled to fill more of the viewport)
+            positions.push_back((i - width/2.0f) * waterScale);
+            positions.push_back((j - height/2.0f) * waterScale);
+        }
+    }
+}
+
+void generateWaterIndices(std::vector<unsigned int>& indices) {
+    indices.clear();
+    indices.reserve(static_cast<size_t>(width - 1) * (height - 1) * 6);
+
+    for (int i = 0; i < width-1; i++) {
+        for (int j = 0; j < height-1; j++) {
+            unsigned int topLeft = i * height + j;
+            unsigned int topRight = topLeft + 1;
+            unsigned int bottomLeft = (i + 1) * height + j;
+            unsigned int bottomRight = bottomLeft + 1;
+            
+            indices.push_back(topLeft);
+            indices.push_back(bottomLeft);
+            indices.push_back(topRight);
+            
+            indices.push_back(topRight);
+            indices.push_back(bottomLeft);
+            indices.push_back(bottomRight);
+        }
+    }
+}
+
+void generateWaterSurface(std::vector<WaterSurfaceVertex>& vertices, float alpha) {
+    vertices.resize(static_cast<size_t>(width) * height);
+    generateWaterSurface(vertices.data(), alpha);
+}
+
+// Heights and normals for columns [colBegin, colEnd) of grid row i
+static void writeSurfaceSpan(WaterSurfaceVertex* out, int i, int colBegin, int colEnd, float alpha) {
+    const std::uint32_t up = packNormal(glm::vec3(0.0f, 0.0f, 1.0f));
+    for (int j = colBegin; j < colEnd; j++, out++) {
+        out->height = getInterpolatedHeight(i, j, alpha);
+
+        // Compute normal using getSurfaceNormal; edges keep the default up normal
+        if (i > 0 && i < width-1 && j > 0 && j < height-1) {
+            out->normal = packNormal(getSurfaceNormal(i, j, alpha));
+        } else {
+            out->normal = up;
+        }
+    }
+}
+
+// Flat water without sampling the field, for inactive tiles
+static void writeFlatSpan(WaterSurfaceVertex* out, int count) {
+    const std::uint32_t up = packNormal(glm::vec3(0.0f, 0.0f, 1.0f));
+    std::fill(out, out + count, WaterSurfaceVertex{0.0f, up});
+}
+
+void generateWaterSurface(WaterSurfaceVertex* out, float alpha) {
+    const ActiveTiles& tiles = activeTiles();
+
+    for (int i = 0; i < width; i++) {
+        const int ti = i / ACTIVE_TILE_SIZE;
+        for (int tj = 0; tj < tiles.cols; tj++) {
+            const int colBegin = tj * ACTIVE_TILE_SIZE;
+            const int colEnd = std::min(colBegin + ACTIVE_TILE_SIZE, height);
+            if (tiles.at(ti, tj)) {
+                writeSurfaceSpan(out + colBegin, i, colBegin, colEnd, alpha);
+            } else {
+                writeFlatSpan(out + colBegin, colEnd - colBegin);
+            }
+        }
+        out += height;
+    }
+}
+
+void generateWaterSurface(std::vector<WaterSurfaceVertex>& vertices, float alpha,
+                          std::vector<unsigned char>& writtenTiles) {
+    vertices.resize(static_cast<size_t>(width) * height);
+    generateWaterSurface(vertices.data(), alpha, writtenTiles);
+}
+
+void generateWaterSurface(WaterSurfaceVertex* out, float alpha, std::vector<unsigned char>& writtenTiles) {
+    const ActiveTiles& tiles = activeTiles();
+    if (writtenTiles.size() != tiles.active.size()) {
+        generateWaterSurface(out, alpha);
+        writtenTiles = tiles.active;
+        return;
+    }
+
+    for (int ti = 0; ti < tiles.rows; ti++) {
+        const int first = ti * ACTIVE_TILE_SIZE;
+        const int last = std::min(first + ACTIVE_TILE_SIZE, width);
+        for (int tj = 0; tj < tiles.cols; tj++) {
+            const int t = ti * tiles.cols + tj;
+            if (!tiles.active[t] && !writtenTiles[t]) {
+                continue;
+            }
+            const int colBegin = tj * ACTIVE_TILE_SIZE;
+            const int colEnd = std::min(colBegin + ACTIVE_TILE_SIZE, height);
+            for (int i = first; i < last; i++) {
+                WaterSurfaceVertex* row = out + static_cast<size_t>(i) * height + colBegin;
+                if (tiles.active[t]) {
+                    writeSurfaceSpan(row, i, colBegin, colEnd, alpha);
+                } else {
+                    writeFlatSpan(row, colEnd - colBegin);
+                }
+            }
+        }
+    }
+    writtenTiles = tiles.active;
+}
+
+void generateWaterHeights(std::vector<float>& heightsOut, float alpha) {
+    heightsOut.resize(static_cast<size_t>(width) * height);
+    float* out = heightsOut.data();
+
+    for (int i = 0; i < width; i++) {
+        for (int j = 0; j < height; j++) {
+            *out++ = getInterpolatedHeight(i, j, alpha);
+        }
+    }
+}
+
+void generateWaterHeights(std::vector<float>& heightsOut, float alpha, std::vector<unsigned char>& writtenTiles) {
+    const ActiveTiles& tiles = activeTiles();
+    const size_t cells = static_cast<size_t>(width) * height;
+    if (heightsOut.size() != cells || writtenTiles.size() != tiles.active.size()) {
+        heightsOut.assign(cells, 0.0f);
+        writtenTiles.assign(tiles.active.size(), 1);
+    }
+
+    for (int ti = 0; ti < tiles.rows; ti++) {
+        const int first = ti * ACTIVE_TILE_SIZE;
+        const int last = std::min(first + ACTIVE_TILE_SIZE, width);
+        for (int tj = 0; tj < tiles.cols; tj++) {
+            const int t = ti * tiles.cols + tj;
+            if (!tiles.active[t] && !writtenTiles[t]) {
+                continue;
+            }
+            // Tiles that went quiet are zero in the field, so sampling
+            // them flattens the stale heights
+            const int colEnd = std::min((tj + 1) * ACTIVE_TILE_SIZE, height);
+            for (int i = first; i < last; i++) {
+                float* out = heightsOut.data() + static_cast<size_t>(i) * height;
+                for (int j = tj * ACTIVE_TILE_SIZE; j < colEnd; j++) {
+                    out[j] = getInterpolatedHeight(i, j, alpha);
+                }
+            }
+        }
+    }
+    writtenTiles = tiles.active;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// The water mesh is split into two vertex streams. The static stream holds
+// the grid's x/y positions and the index buffer never changes, so both are
+// built once. Only the dynamic stream below is regenerated per frame.
+
+// Dynamic per-vertex data: height plus the surface normal packed as signed
+// normalized 10:10:10:2 (GL_INT_2_10_10_10_REV), 8 bytes per vertex
+struct WaterSurfaceVertex {
+    float height;
+    std::uint32_t normal;
+};
+
+// Packs a unit normal into the 10:10:10:2 signed normalized layout
+inline std::uint32_t packNormal(const glm::vec3& n) {
+    auto pack = [](float v) {
+        v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+        int q = static_cast<int>(v * 511.0f + (v < 0.0f ? -0.5f : 0.5f));
+        return static_cast<std::uint32_t>(q) & 0x3FFu;
+    };
+    return pack(n.x) | (pack(n.y) << 10) | (pack(n.z) << 20);
+}
+
+// Static x/y position per grid cell, 2 floats each
+void generateWaterGridXY(std::vector<float>& positions);
+
+// Two triangles per grid quad, indexing the vertices above
+void generateWaterIndices(std::vector<unsigned int>& indices);
+
+// Heights and normals for every grid cell. alpha blends between the previous
+// and current solver tick (1 = current). Cells of inactive tiles (see
+// activeTiles()) are written as flat water without sampling the field.
+void generateWaterSurface(std::vector<WaterSurfaceVertex>& vertices, float alpha = 1.0f);
+
+// Same, writing width * height vertices straight into caller-owned memory
+// such as a mapped GL buffer
+void generateWaterSurface(WaterSurfaceVertex* vertices, float alpha = 1.0f);
+
+// Same, but only rewrites the tiles that are active now or were active when
+// vertices was last written, which writtenTiles records (empty = unknown,
+// write everything). Everything else in vertices is already flat water.
+void generateWaterSurface(std::vector<WaterSurfaceVertex>& vertices, float alpha,
+                          std::vector<unsigned char>& writtenTiles);
+void generateWaterSurface(WaterSurfaceVertex* vertices, float alpha, std::vector<unsigned char>& writtenTiles);
+
+// Heights only, one float per grid cell in vertex order, for renderers that
+// displace the static grid in the vertex shader and rebuild normals there
+void generateWaterHeights(std::vector<float>& heightsOut, float alpha = 1.0f);
+
+// Same, but only rewrites the tiles that are active now or were active when
+// heightsOut was last written, which writtenTiles records (empty = unknown,
+// write everything). Everything else in heightsOut is already flat water.
+void generateWaterHeights(std::vector<float>& heightsOut, float alpha, std::vector<unsigned char>& writtenTiles);
@@ -0,0 +1,247 @@
+#include "wave_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CAUSTICS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+void waveRowScalar(const float* up, const float* mid, const float* down,
+                   const float* prev, float* next, int begin, int end,
+                   float keep, float coeff) {
+    for (int j = begin; j < end; ++j) {
+        float laplacian =
+            down[j] +
+            up[j] +
+            mid[j + 1] +
+            mid[j - 1] -
+            4 * mid[j];
+
+        next[j] = keep * (2 * mid[j] - prev[j]) + coeff * laplacian;
+    }
+}
+
+float rowPeakScalar(const float* row, int begin, int end) {
+    float peak = 0.0f;
+    for (int j = begin; j < end; ++j) {
+        peak = std::max(peak, std::abs(row[j]));
+    }
+    return peak;
+}
+
+void stampRowScalar(float* row, int begin, int end, float center, float rowOffset2,
+                    float invRadius2, float amplitude) {
+    for (int j = begin; j < end; ++j) {
+        float offset = j - center;
+        float t = std::max(0.0f, 1.0f - (offset * offset + rowOffset2) * invRadius2);
+        row[j] += amplitude * (t * t * t);
+    }
+}
+
+#ifdef CAUSTICS_X86_SIMD
+
+__attribute__((target("sse2")))
+static void waveRowSSE(const float* up, const float* mid, const float* down,
+                       const float* prev, float* next, int begin, int end,
+                       float keep, float coeff) {
+    const __m128 vKeep = _mm_set1_ps(keep);
+    const __m128 vCoeff = _mm_set1_ps(coeff);
+    const __m128 vTwo = _mm_set1_ps(2.0f);
+    const __m128 vFour = _mm_set1_ps(4.0f);
+
+    int j = begin;
+    for (; j + 4 <= end; j += 4) {
+        __m128 center = _mm_loadu_ps(mid + j);
+        __m128 laplacian = _mm_add_ps(_mm_loadu_ps(down + j), _mm_loadu_ps(up + j));
+        laplacian = _mm_add_ps(laplacian, _mm_loadu_ps(mid + j + 1));
+        laplacian = _mm_add_ps(laplacian, _mm_loadu_ps(mid + j - 1));
+        laplacian = _mm_sub_ps(laplacian, _mm_mul_ps(vFour, center));
+
+        __m128 history = _mm_sub_ps(_mm_mul_ps(vTwo, center), _mm_loadu_ps(prev + j));
+        __m128 result = _mm_add_ps(_mm_mul_ps(vKeep, history), _mm_mul_ps(vCoeff, laplacian));
+        _mm_storeu_ps(next + j, result);
+    }
+    waveRowScalar(up, mid, down, prev, next, j, end, keep, coeff);
+}
+
+__attribute__((target("avx2")))
+static void waveRowAVX2(const float* up, const float* mid, const float* down,
+                        const float* prev, float* next, int begin, int end,
+                        float keep, float coeff) {
+    const __m256 vKeep = _mm256_set1_ps(keep);
+    const __m256 vCoeff = _mm256_set1_ps(coeff);
+    const __m256 vTwo = _mm256_set1_ps(2.0f);
+    const __m256 vFour = _mm256_set1_ps(4.0f);
+
+    int j = begin;
+    for (; j + 8 <= end; j += 8) {
+        __m256 center = _mm256_loadu_ps(mid + j);
+        __m256 laplacian = _mm256_add_ps(_mm256_loadu_ps(down + j), _mm256_loadu_ps(up + j));
+        laplacian = _mm256_add_ps(laplacian, _mm256_loadu_ps(mid + j + 1));
+        laplacian = _mm256_add_ps(laplacian, _mm256_loadu_ps(mid + j - 1));
+        laplacian = _mm256_sub_ps(laplacian, _mm256_mul_ps(vFour, center));
+
+        __m256 history = _mm256_sub_ps(_mm256_mul_ps(vTwo, center), _mm256_loadu_ps(prev + j));
+        __m256 result = _mm256_add_ps(_mm256_mul_ps(vKeep, history), _mm256_mul_ps(vCoeff, laplacian));
+        _mm256_storeu_ps(next + j, result);
+    }
+    waveRowScalar(up, mid, down, prev, next, j, end, keep, coeff);
+}
+
+__attribute__((target("avx512f")))
+static void waveRowAVX512(const float* up, const float* mid, const float* down,
+                          const float* prev, float* next, int begin, int end,
+                          float keep, float coeff) {
+    const __m512 vKeep = _mm512_set1_ps(keep);
+    const __m512 vCoeff = _mm512_set1_ps(coeff);
+    const __m512 vTwo = _mm512_set1_ps(2.0f);
+    const __m512 vFour = _mm512_set1_ps(4.0f);
+
+    int j = begin;
+    for (; j + 16 <= end; j += 16) {
+        __m512 center = _mm512_loadu_ps(mid + j);
+        __m512 laplacian = _mm512_add_ps(_mm512_loadu_ps(down + j), _mm512_loadu_ps(up + j));
+        laplacian = _mm512_add_ps(laplacian, _mm512_loadu_ps(mid + j + 1));
+        laplacian = _mm512_add_ps(laplacian, _mm512_loadu_ps(mid + j - 1));
+        laplacian = _mm512_sub_ps(laplacian, _mm512_mul_ps(vFour, center));
+
+        __m512 history = _mm512_sub_ps(_mm512_mul_ps(vTwo, center), _mm512_loadu_ps(prev + j));
+        __m512 result = _mm512_add_ps(_mm512_mul_ps(vKeep, history), _mm512_mul_ps(vCoeff, laplacian));
+        _mm512_storeu_ps(next + j, result);
+    }
+    waveRowScalar(up, mid, down, prev, next, j, end, keep, coeff);
+}
+
+__attribute__((target("sse2")))
+static float rowPeakSSE(const float* row, int begin, int end) {
+    const __m128 vSign = _mm_set1_ps(-0.0f);
+    __m128 peak = _mm_setzero_ps();
+    int j = begin;
+    for (; j + 4 <= end; j += 4) {
+        peak = _mm_max_ps(peak, _mm_andnot_ps(vSign, _mm_loadu_ps(row + j)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, peak);
+    float tail = rowPeakScalar(row, j, end);
+    return std::max(std::max(lanes[0], lanes[1]), std::max(std::max(lanes[2], lanes[3]), tail));
+}
+
+__attribute__((target("avx2")))
+static float rowPeakAVX2(const float* row, int begin, int end) {
+    const __m256 vSign = _mm256_set1_ps(-0.0f);
+    __m256 peak = _mm256_setzero_ps();
+    int j = begin;
+    for (; j + 8 <= end; j += 8) {
+        peak = _mm256_max_ps(peak, _mm256_andnot_ps(vSign, _mm256_loadu_ps(row + j)));
+    }
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+    float lanes[4];
+    _mm_storeu_ps(lanes, half);
+    float tail = rowPeakScalar(row, j, end);
+    return std::max(std::max(lanes[0], lanes[1]), std::max(std::max(lanes[2], lanes[3]), tail));
+}
+
+__attribute__((target("sse2")))
+static void stampRowSSE(float* row, int begin, int end, float center, float rowOffset2,
+                        float invRadius2, float amplitude) {
+    const __m128 vRowOffset2 = _mm_set1_ps(rowOffset2);
+    const __m128 vInvRadius2 = _mm_set1_ps(invRadius2);
+    const __m128 vAmplitude = _mm_set1_ps(amplitude);
+    const __m128 vOne = _mm_set1_ps(1.0f);
+    const __m128 vCenter = _mm_set1_ps(center);
+    const __m128 vLanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+    int j = begin;
+    for (; j + 4 <= end; j += 4) {
+        // Column minus centre, rounded exactly as in the scalar kernel
+        __m128 offset = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(j)), vLanes), vCenter);
+        __m128 distance2 = _mm_add_ps(_mm_mul_ps(offset, offset), vRowOffset2);
+        __m128 t = _mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(vOne, _mm_mul_ps(distance2, vInvRadius2)));
+        __m128 weight = _mm_mul_ps(_mm_mul_ps(t, t), t);
+        _mm_storeu_ps(row + j, _mm_add_ps(_mm_loadu_ps(row + j), _mm_mul_ps(vAmplitude, weight)));
+    }
+    stampRowScalar(row, j, end, center, rowOffset2, invRadius2, amplitude);
+}
+
+__attribute__((target("avx2")))
+static void stampRowAVX2(float* row, int begin, int end, float center, float rowOffset2,
+                         float invRadius2, float amplitude) {
+    const __m256 vRowOffset2 = _mm256_set1_ps(rowOffset2);
+    const __m256 vInvRadius2 = _mm256_set1_ps(invRadius2);
+    const __m256 vAmplitude = _mm256_set1_ps(amplitude);
+    const __m256 vOne = _mm256_set1_ps(1.0f);
+    const __m256 vCenter = _mm256_set1_ps(center);
+    const __m256 vLanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+    int j = begin;
+    for (; j + 8 <= end; j += 8) {
+        // Column minus centre, rounded exactly as in the scalar kernel
+        __m256 offset = _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(j)), vLanes), vCenter);
+        __m256 distance2 = _mm256_add_ps(_mm256_mul_ps(offset, offset), vRowOffset2);
+        __m256 t = _mm256_max_ps(_mm256_setzero_ps(), _mm256_sub_ps(vOne, _mm256_mul_ps(distance2, vInvRadius2)));
+        __m256 weight = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+        _mm256_storeu_ps(row + j, _mm256_add_ps(_mm256_loadu_ps(row + j), _mm256_mul_ps(vAmplitude, weight)));
+    }
+    stampRowScalar(row, j, end, center, rowOffset2, invRadius2, amplitude);
+}
+
+#endif // CAUSTICS_X86_SIMD
+
+SimdIsa detectSimdIsa() {
+#ifdef CAUSTICS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdIsa::AVX512;
+    if (__builtin_cpu_supports("avx2")) return SimdIsa::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdIsa::SSE;
+#endif
+    return SimdIsa::Scalar;
+}
+
+const char* simdIsaName(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::SSE: return "SSE";
+        case SimdIsa::AVX2: return "AVX2";
+        case SimdIsa::AVX512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+WaveRowKernel getWaveRowKernel(SimdIsa isa) {
+#ifdef CAUSTICS_X86_SIMD
+    switch (isa) {
+        case SimdIsa::SSE: return waveRowSSE;
+        case SimdIsa::AVX2: return waveRowAVX2;
+        case SimdIsa::AVX512: return waveRowAVX512;
+        default: break;
+    }
+#endif
+    return waveRowScalar;
+}
+
+RowPeakKernel getRowPeakKernel(SimdIsa isa) {
+#ifdef CAUSTICS_X86_SIMD
+    switch (isa) {
+        case SimdIsa::SSE: return rowPeakSSE;
+        // The pass is light next to the stencil; 256-bit vectors are plenty
+        case SimdIsa::AVX2:
+        case SimdIsa::AVX512: return rowPeakAVX2;
+        default: break;
+    }
+#endif
+    return rowPeakScalar;
+}
+
+StampRowKernel getStampRowKernel(SimdIsa isa) {
+#ifdef CAUSTICS_X86_SIMD
+    switch (isa) {
+        case SimdIsa::SSE: return stampRowSSE;
+        // Stamps are a few cells across; wider vectors would mostly idle
+        case SimdIsa::AVX2:
+        case SimdIsa::AVX512: return stampRowAVX2;
+        default: break;
+    }
+#endif
+    return stampRowScalar;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// Row kernels for the 5-point wave equation stencil.
+//
+// Every kernel computes, for j in [begin, end):
+//   next[j] = keep * (2 * mid[j] - prev[j]) + coeff * laplacian
+//   laplacian = down[j] + up[j] + mid[j + 1] + mid[j - 1] - 4 * mid[j]
+// with keep = 1 - damping and coeff = c^2 dt^2 / dx^2. The SIMD variants
+// perform the same operations in the same order without fused multiply-add,
+// so they are bit-identical to the scalar version.
+typedef void (*WaveRowKernel)(const float* up, const float* mid, const float* down,
+                              const float* prev, float* next, int begin, int end,
+                              float keep, float coeff);
+
+enum class SimdIsa {
+    Scalar,
+    SSE,
+    AVX2,
+    AVX512
+};
+
+// Widest instruction set that is both compiled in and supported by this CPU
+SimdIsa detectSimdIsa();
+const char* simdIsaName(SimdIsa isa);
+
+// Kernel for the given ISA; falls back to scalar if it is not available
+WaveRowKernel getWaveRowKernel(SimdIsa isa);
+
+void waveRowScalar(const float* up, const float* mid, const float* down,
+                   const float* prev, float* next, int begin, int end,
+                   float keep, float coeff);
+
+// Largest |row[j]| for j in [begin, end), 0 for an empty range; used by the
+// sparse solver to tell calm tiles from active ones
+typedef float (*RowPeakKernel)(const float* row, int begin, int end);
+
+RowPeakKernel getRowPeakKernel(SimdIsa isa);
+
+float rowPeakScalar(const float* row, int begin, int end);
+
+// One row of a smooth radial disturbance stamp. For j in [begin, end):
+//   t = max(0, 1 - ((j - center)^2 + rowOffset2) * invRadius2)
+//   row[j] += amplitude * t^3
+// where rowOffset2 is the squared distance of the row from the stamp centre
+typedef void (*StampRowKernel)(float* row, int begin, int end, float center, float rowOffset2,
+                               float invRadius2, float amplitude);
+
+StampRowKernel getStampRowKernel(SimdIsa isa);
+
+void stampRowScalar(float* row, int begin, int end, float center, float rowOffset2,
+                    float invRadius2, float amplitude);